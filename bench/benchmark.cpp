@@ -0,0 +1,574 @@
+// mini-redis-benchmark: 基于 RESP 流水线的负载生成器
+//
+// 在 M 个线程上打开 N 个连接，按配置的比例发送 SET/GET/EXPIRE/MULTI，
+// 统计吞吐量与 HDR 直方图延迟分位数，并可输出 CSV/JSON 以便跨提交对比。
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "histogram.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    enum OpType { OP_SET = 0, OP_GET, OP_EXPIRE, OP_MULTI, OP_COUNT };
+    constexpr std::array<const char*, OP_COUNT> OP_NAMES = {"SET", "GET", "EXPIRE", "MULTI"};
+
+    struct Config {
+        std::string host{"127.0.0.1"};
+        int port{6379};
+        std::string socket_path;  // 非空时通过 Unix domain socket 连接
+        int clients{50};
+        int threads{4};
+        uint64_t requests{100000};
+        int pipeline{1};
+        uint64_t keyspace{10000};
+        size_t value_size{64};
+        std::array<int, OP_COUNT> mix{50, 50, 0, 0};
+        int expire_seconds{100};
+        std::string csv_file;
+        std::string json_file;
+        std::string label;
+    };
+
+    struct Stats {
+        std::array<Histogram, OP_COUNT> latency;  // 单位：微秒
+        std::array<uint64_t, OP_COUNT> errors{};
+    };
+
+    struct Pending {
+        OpType type;
+        int replies;  // 该操作还需要等待的回复数（MULTI 事务为 4）
+        Clock::time_point start;
+    };
+
+    struct Connection {
+        int fd{-1};
+        std::string out;
+        std::string in;
+        std::deque<Pending> pending;
+        bool failed{false};  // 当前操作是否收到过错误回复
+    };
+
+    void usage() {
+        std::cerr
+            << "Usage: mini-redis-benchmark [options]\n"
+               "  -h <host>        server host (default 127.0.0.1)\n"
+               "  -p <port>        server port (default 6379)\n"
+               "  -s <socket>      server unix socket (overrides host and port)\n"
+               "  -c <clients>     number of connections (default 50)\n"
+               "  -t <threads>     number of worker threads (default 4)\n"
+               "  -n <requests>    total number of operations (default 100000)\n"
+               "  -P <pipeline>    operations in flight per connection (default 1)\n"
+               "  -r <keyspace>    number of distinct keys (default 10000)\n"
+               "  -d <size>        value size in bytes (default 64)\n"
+               "  --mix <spec>     weights, e.g. set=50,get=40,expire=5,multi=5\n"
+               "  --csv <file>     append results as CSV rows\n"
+               "  --json <file>    write results as JSON\n"
+               "  --label <name>   tag stored with the results (e.g. commit id)\n";
+    }
+
+    void parseMix(const std::string& spec, std::array<int, OP_COUNT>& mix) {
+        mix.fill(0);
+        std::stringstream ss(spec);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            size_t eq = item.find('=');
+            if (eq == std::string::npos) {
+                throw std::invalid_argument("bad mix entry: " + item);
+            }
+            std::string name = item.substr(0, eq);
+            for (auto& ch : name) {
+                ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+            }
+            int weight = std::stoi(item.substr(eq + 1));
+            bool found = false;
+            for (int i = 0; i < OP_COUNT; ++i) {
+                if (name == OP_NAMES[i]) {
+                    mix[i] = weight;
+                    found = true;
+                }
+            }
+            if (!found || weight < 0) {
+                throw std::invalid_argument("bad mix entry: " + item);
+            }
+        }
+        int total = 0;
+        for (int w : mix) {
+            total += w;
+        }
+        if (total == 0) {
+            throw std::invalid_argument("mix must have at least one non-zero weight");
+        }
+    }
+
+    Config parseArgs(int argc, char** argv) {
+        Config cfg;
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + std::string(arg));
+            }
+            std::string value = argv[++i];
+            if (arg == "-h") {
+                cfg.host = value;
+            } else if (arg == "-p") {
+                cfg.port = std::stoi(value);
+            } else if (arg == "-s") {
+                cfg.socket_path = value;
+            } else if (arg == "-c") {
+                cfg.clients = std::stoi(value);
+            } else if (arg == "-t") {
+                cfg.threads = std::stoi(value);
+            } else if (arg == "-n") {
+                cfg.requests = std::stoull(value);
+            } else if (arg == "-P") {
+                cfg.pipeline = std::stoi(value);
+            } else if (arg == "-r") {
+                cfg.keyspace = std::stoull(value);
+            } else if (arg == "-d") {
+                cfg.value_size = std::stoull(value);
+            } else if (arg == "--mix") {
+                parseMix(value, cfg.mix);
+            } else if (arg == "--csv") {
+                cfg.csv_file = value;
+            } else if (arg == "--json") {
+                cfg.json_file = value;
+            } else if (arg == "--label") {
+                cfg.label = value;
+            } else {
+                throw std::invalid_argument("unknown option " + std::string(arg));
+            }
+        }
+        if (cfg.clients <= 0 || cfg.threads <= 0 || cfg.pipeline <= 0 || cfg.keyspace == 0) {
+            throw std::invalid_argument("clients, threads, pipeline and keyspace must be positive");
+        }
+        if (cfg.threads > cfg.clients) {
+            cfg.threads = cfg.clients;
+        }
+        return cfg;
+    }
+
+    int connectUnix(const Config& cfg) {
+        sockaddr_un addr{};
+        if (cfg.socket_path.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("Socket path too long: " + cfg.socket_path);
+        }
+        addr.sun_family = AF_UNIX;
+        cfg.socket_path.copy(addr.sun_path, cfg.socket_path.size());
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create socket");
+        }
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            throw std::runtime_error("Connect failed: " + std::string(std::strerror(errno)));
+        }
+        return fd;
+    }
+
+    int connectTo(const Config& cfg) {
+        if (!cfg.socket_path.empty()) {
+            return connectUnix(cfg);
+        }
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create socket");
+        }
+        int opt = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(cfg.port);
+        if (inet_pton(AF_INET, cfg.host.c_str(), &addr.sin_addr) != 1) {
+            close(fd);
+            throw std::runtime_error("Invalid host address: " + cfg.host);
+        }
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            throw std::runtime_error("Connect failed: " + std::string(std::strerror(errno)));
+        }
+        return fd;
+    }
+
+    void appendCommand(std::string& out, std::initializer_list<std::string_view> args) {
+        out += "*" + std::to_string(args.size()) + "\r\n";
+        for (auto arg : args) {
+            out += "$" + std::to_string(arg.size()) + "\r\n";
+            out += arg;
+            out += "\r\n";
+        }
+    }
+
+    /**
+     * 返回 buffer 开头一个完整 RESP 回复的字节数，数据不完整时返回 0
+     */
+    size_t replyLength(std::string_view buffer, size_t pos = 0) {
+        if (pos >= buffer.size()) {
+            return 0;
+        }
+        size_t eol = buffer.find("\r\n", pos);
+        if (eol == std::string_view::npos) {
+            return 0;
+        }
+        size_t line_end = eol + 2;
+        char type = buffer[pos];
+        if (type == '+' || type == '-' || type == ':') {
+            return line_end - pos;
+        }
+        long long n = std::stoll(std::string(buffer.substr(pos + 1, eol - pos - 1)));
+        if (type == '$') {
+            if (n < 0) {
+                return line_end - pos;
+            }
+            size_t end = line_end + static_cast<size_t>(n) + 2;
+            return end <= buffer.size() ? end - pos : 0;
+        }
+        if (type == '*') {
+            size_t cur = line_end;
+            for (long long i = 0; i < n; ++i) {
+                size_t len = replyLength(buffer, cur);
+                if (len == 0) {
+                    return 0;
+                }
+                cur += len;
+            }
+            return cur - pos;
+        }
+        throw std::runtime_error("Unexpected reply type from server");
+    }
+
+    class Worker {
+    public:
+        Worker(const Config& cfg, int connections, uint64_t quota, uint64_t seed)
+            : cfg_(cfg), quota_(quota), rng_(seed), value_(cfg.value_size, 'x') {
+            for (int w : cfg.mix) {
+                mix_total_ += w;
+            }
+            conns_.resize(connections);
+            for (auto& conn : conns_) {
+                conn.fd = connectTo(cfg);
+            }
+        }
+
+        ~Worker() {
+            for (auto& conn : conns_) {
+                if (conn.fd >= 0) {
+                    close(conn.fd);
+                }
+            }
+        }
+
+        void run() {
+            std::vector<pollfd> pfds(conns_.size());
+            while (true) {
+                bool inflight = false;
+                for (auto& conn : conns_) {
+                    if (conn.pending.empty() && quota_ > 0) {
+                        fill(conn);
+                    }
+                    inflight = inflight || !conn.pending.empty();
+                }
+                if (!inflight) {
+                    break;
+                }
+
+                for (size_t i = 0; i < conns_.size(); ++i) {
+                    pfds[i].fd = conns_[i].pending.empty() ? -1 : conns_[i].fd;
+                    pfds[i].events = POLLIN;
+                    pfds[i].revents = 0;
+                }
+                if (poll(pfds.data(), pfds.size(), -1) < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::runtime_error("poll failed");
+                }
+                for (size_t i = 0; i < conns_.size(); ++i) {
+                    if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                        readReplies(conns_[i]);
+                    }
+                }
+            }
+        }
+
+        const Stats& stats() const { return stats_; }
+
+    private:
+        OpType pickOp() {
+            int r = static_cast<int>(rng_() % static_cast<uint64_t>(mix_total_));
+            for (int i = 0; i < OP_COUNT; ++i) {
+                if (r < cfg_.mix[i]) {
+                    return static_cast<OpType>(i);
+                }
+                r -= cfg_.mix[i];
+            }
+            return OP_GET;
+        }
+
+        // 为一个空闲连接生成一整批（pipeline 深度）请求并一次写出
+        void fill(Connection& conn) {
+            conn.out.clear();
+            int batch = static_cast<int>(std::min<uint64_t>(cfg_.pipeline, quota_));
+            quota_ -= batch;
+            auto start = Clock::now();
+            for (int i = 0; i < batch; ++i) {
+                OpType op = pickOp();
+                std::string key = "key:" + std::to_string(rng_() % cfg_.keyspace);
+                std::string ttl = std::to_string(cfg_.expire_seconds);
+                int replies = 1;
+                switch (op) {
+                    case OP_SET:
+                        appendCommand(conn.out, {"SET", key, value_});
+                        break;
+                    case OP_GET:
+                        appendCommand(conn.out, {"GET", key});
+                        break;
+                    case OP_EXPIRE:
+                        appendCommand(conn.out, {"EXPIRE", key, ttl});
+                        break;
+                    case OP_MULTI:
+                        appendCommand(conn.out, {"MULTI"});
+                        appendCommand(conn.out, {"SET", key, value_});
+                        appendCommand(conn.out, {"EXPIRE", key, ttl});
+                        appendCommand(conn.out, {"EXEC"});
+                        replies = 4;
+                        break;
+                    default:
+                        break;
+                }
+                conn.pending.push_back({op, replies, start});
+            }
+
+            size_t sent = 0;
+            while (sent < conn.out.size()) {
+                ssize_t n = send(conn.fd, conn.out.data() + sent, conn.out.size() - sent, 0);
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::runtime_error("send failed: " + std::string(std::strerror(errno)));
+                }
+                sent += static_cast<size_t>(n);
+            }
+        }
+
+        void readReplies(Connection& conn) {
+            char buffer[16384];
+            ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) {
+                    return;
+                }
+                throw std::runtime_error("Connection closed by server");
+            }
+            conn.in.append(buffer, static_cast<size_t>(n));
+
+            size_t pos = 0;
+            while (!conn.pending.empty()) {
+                size_t len = replyLength(conn.in, pos);
+                if (len == 0) {
+                    break;
+                }
+                if (conn.in[pos] == '-') {
+                    conn.failed = true;
+                }
+                pos += len;
+
+                Pending& op = conn.pending.front();
+                if (--op.replies > 0) {
+                    continue;
+                }
+                auto us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                                                op.start);
+                stats_.latency[op.type].record(static_cast<uint64_t>(us.count()));
+                if (conn.failed) {
+                    ++stats_.errors[op.type];
+                    conn.failed = false;
+                }
+                conn.pending.pop_front();
+            }
+            conn.in.erase(0, pos);
+        }
+
+        const Config& cfg_;
+        uint64_t quota_;
+        int mix_total_{0};
+        std::mt19937_64 rng_;
+        std::string value_;
+        std::vector<Connection> conns_;
+        Stats stats_;
+    };
+
+    struct Row {
+        std::string op;
+        const Histogram* hist;
+        uint64_t errors;
+    };
+
+    void printReport(const Config& cfg, const std::vector<Row>& rows, double seconds) {
+        std::cout << "clients=" << cfg.clients << " threads=" << cfg.threads
+                  << " pipeline=" << cfg.pipeline << " keyspace=" << cfg.keyspace
+                  << " value_size=" << cfg.value_size << "\n";
+        std::cout << std::left << std::setw(8) << "op" << std::right << std::setw(12) << "requests"
+                  << std::setw(14) << "ops/sec" << std::setw(10) << "p50(us)" << std::setw(10)
+                  << "p99(us)" << std::setw(11) << "p99.9(us)" << std::setw(10) << "max(us)"
+                  << std::setw(8) << "errors" << "\n";
+        for (const auto& row : rows) {
+            std::cout << std::left << std::setw(8) << row.op << std::right << std::setw(12)
+                      << row.hist->count() << std::setw(14) << std::fixed << std::setprecision(0)
+                      << row.hist->count() / seconds << std::setw(10) << row.hist->percentile(50)
+                      << std::setw(10) << row.hist->percentile(99) << std::setw(11)
+                      << row.hist->percentile(99.9) << std::setw(10) << row.hist->max()
+                      << std::setw(8) << row.errors << "\n";
+        }
+    }
+
+    void writeCsv(const Config& cfg, const std::vector<Row>& rows, double seconds) {
+        bool fresh = !std::filesystem::exists(cfg.csv_file);
+        std::ofstream out(cfg.csv_file, std::ios::app);
+        if (!out.is_open()) {
+            throw std::runtime_error("Failed to open CSV file: " + cfg.csv_file);
+        }
+        if (fresh) {
+            out << "label,op,clients,threads,pipeline,keyspace,value_size,requests,seconds,"
+                   "ops_per_sec,p50_us,p99_us,p999_us,max_us,mean_us,errors\n";
+        }
+        for (const auto& row : rows) {
+            out << cfg.label << "," << row.op << "," << cfg.clients << "," << cfg.threads << ","
+                << cfg.pipeline << "," << cfg.keyspace << "," << cfg.value_size << ","
+                << row.hist->count() << "," << seconds << "," << row.hist->count() / seconds
+                << "," << row.hist->percentile(50) << "," << row.hist->percentile(99) << ","
+                << row.hist->percentile(99.9) << "," << row.hist->max() << ","
+                << row.hist->mean() << "," << row.errors << "\n";
+        }
+    }
+
+    void writeJson(const Config& cfg, const std::vector<Row>& rows, double seconds) {
+        std::ofstream out(cfg.json_file, std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Failed to open JSON file: " + cfg.json_file);
+        }
+        out << "{\n  \"label\": \"" << cfg.label << "\",\n"
+            << "  \"config\": {\"clients\": " << cfg.clients << ", \"threads\": " << cfg.threads
+            << ", \"pipeline\": " << cfg.pipeline << ", \"keyspace\": " << cfg.keyspace
+            << ", \"value_size\": " << cfg.value_size << "},\n"
+            << "  \"seconds\": " << seconds << ",\n  \"results\": [\n";
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const auto& row = rows[i];
+            out << "    {\"op\": \"" << row.op << "\", \"requests\": " << row.hist->count()
+                << ", \"ops_per_sec\": " << row.hist->count() / seconds
+                << ", \"p50_us\": " << row.hist->percentile(50)
+                << ", \"p99_us\": " << row.hist->percentile(99)
+                << ", \"p999_us\": " << row.hist->percentile(99.9)
+                << ", \"max_us\": " << row.hist->max() << ", \"mean_us\": " << row.hist->mean()
+                << ", \"errors\": " << row.errors << "}" << (i + 1 < rows.size() ? "," : "")
+                << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    try {
+        cfg = parseArgs(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        usage();
+        return 1;
+    }
+
+    // 连接与请求配额尽量平均分给各线程
+    std::vector<std::unique_ptr<Worker>> workers;
+    try {
+        for (int t = 0; t < cfg.threads; ++t) {
+            int conns = cfg.clients / cfg.threads + (t < cfg.clients % cfg.threads ? 1 : 0);
+            uint64_t quota = cfg.requests / cfg.threads +
+                             (static_cast<uint64_t>(t) < cfg.requests % cfg.threads ? 1 : 0);
+            uint64_t seed = 0x9e3779b97f4a7c15ULL * static_cast<uint64_t>(t + 1);
+            workers.push_back(std::make_unique<Worker>(cfg, conns, quota, seed));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::atomic<bool> failed{false};
+    auto begin = Clock::now();
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        threads.emplace_back([&worker, &failed]() {
+            try {
+                worker->run();
+            } catch (const std::exception& e) {
+                std::cerr << "worker error: " << e.what() << "\n";
+                failed = true;
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    if (failed) {
+        return 1;
+    }
+
+    Stats total;
+    Histogram all;
+    uint64_t all_errors = 0;
+    for (auto& worker : workers) {
+        for (int i = 0; i < OP_COUNT; ++i) {
+            total.latency[i].merge(worker->stats().latency[i]);
+            total.errors[i] += worker->stats().errors[i];
+        }
+    }
+    std::vector<Row> rows;
+    for (int i = 0; i < OP_COUNT; ++i) {
+        if (total.latency[i].count() > 0) {
+            rows.push_back({OP_NAMES[i], &total.latency[i], total.errors[i]});
+            all.merge(total.latency[i]);
+            all_errors += total.errors[i];
+        }
+    }
+    rows.push_back({"ALL", &all, all_errors});
+
+    printReport(cfg, rows, seconds);
+    try {
+        if (!cfg.csv_file.empty()) {
+            writeCsv(cfg, rows, seconds);
+        }
+        if (!cfg.json_file.empty()) {
+            writeJson(cfg, rows, seconds);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
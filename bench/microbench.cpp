@@ -0,0 +1,420 @@
+// mini-redis-microbench: 热点组件的微基准测试
+//
+// 分别测量 Command::parseResp、RingBuffer、HotKeys、Value 压缩、Store 与 AOF 的单次操作耗时（ns/op）
+// 和内存分配次数（allocs/op），用于客观评估热路径上的改动。
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "client.hpp"
+#include "command.hpp"
+#include "hotkeys.hpp"
+#include "ring_buffer.hpp"
+#include "store.hpp"
+#include "value.hpp"
+
+// 统计全局 operator new 的调用次数，用于计算 allocs/op
+namespace {
+    std::atomic<uint64_t> g_allocations{0};
+}
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::string filter;
+        uint64_t max_keys{1000000};
+        size_t value_size{64};
+    };
+
+    // 防止编译器把被测结果当作死代码消除
+    template <typename T>
+    void doNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    class Runner {
+    public:
+        explicit Runner(const Options& opts) : opts_(opts) {
+            std::cout << std::left << std::setw(44) << "benchmark" << std::right << std::setw(12)
+                      << "ops" << std::setw(14) << "ns/op" << std::setw(14) << "allocs/op"
+                      << "\n";
+        }
+
+        bool enabled(const std::string& name) const {
+            return opts_.filter.empty() || name.find(opts_.filter) != std::string::npos;
+        }
+
+        // body 需要执行 ops 次被测操作
+        template <typename F>
+        void run(const std::string& name, uint64_t ops, F&& body) {
+            if (!enabled(name) || ops == 0) {
+                return;
+            }
+            uint64_t allocs_before = g_allocations.load(std::memory_order_relaxed);
+            auto start = Clock::now();
+            body();
+            auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            uint64_t allocs = g_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+            std::cout << std::left << std::setw(44) << name << std::right << std::setw(12) << ops
+                      << std::setw(14) << std::fixed << std::setprecision(1) << elapsed / ops
+                      << std::setw(14) << std::setprecision(2)
+                      << static_cast<double>(allocs) / ops << "\n";
+        }
+
+        // 后续用例依赖其结果的步骤：被过滤时仍然执行，只是不输出
+        template <typename F>
+        void setup(const std::string& name, uint64_t ops, F&& body) {
+            if (enabled(name)) {
+                run(name, ops, std::forward<F>(body));
+            } else {
+                body();
+            }
+        }
+
+    private:
+        const Options& opts_;
+    };
+
+    void appendCommand(std::string& out, const std::vector<std::string_view>& args) {
+        out += "*" + std::to_string(args.size()) + "\r\n";
+        for (auto arg : args) {
+            out += "$" + std::to_string(arg.size()) + "\r\n";
+            out += arg;
+            out += "\r\n";
+        }
+    }
+
+    std::string makeKey(uint64_t i) { return "key:" + std::to_string(i); }
+
+    std::filesystem::path tempAof(const std::string& name) {
+        auto path = std::filesystem::temp_directory_path() /
+                    ("mini-redis-microbench-" + std::to_string(getpid()) + "-" + name + ".aof");
+        std::filesystem::remove(path);
+        return path;
+    }
+
+    void benchParser(Runner& runner, const Options& opts) {
+        // 模拟客户端一次性发送的流水线缓冲区：SET 与 GET 交替
+        constexpr int COMMANDS = 1000;
+        std::string value(opts.value_size, 'x');
+        std::string pipeline;
+        for (int i = 0; i < COMMANDS; ++i) {
+            std::string key = makeKey(i);
+            if (i % 2 == 0) {
+                appendCommand(pipeline, {"SET", key, value});
+            } else {
+                appendCommand(pipeline, {"GET", key});
+            }
+        }
+
+        constexpr int ROUNDS = 200;
+        runner.run("parseResp/pipelined SET+GET", uint64_t{COMMANDS} * ROUNDS, [&]() {
+            std::vector<std::string_view> tokens;
+            for (int r = 0; r < ROUNDS; ++r) {
+                std::string_view buffer = pipeline;
+                size_t consumed = 0;
+                while (!buffer.empty() && Command::parseResp(buffer, consumed, tokens) ==
+                                              Command::ParseResult::Ok) {
+                    buffer.remove_prefix(consumed);
+                    doNotOptimize(tokens);
+                }
+            }
+        });
+
+        // 截断在命令中间的缓冲区：覆盖不完整数据的失败路径
+        std::string_view partial = std::string_view(pipeline).substr(0, pipeline.size() / 2 + 7);
+        runner.run("parseResp/pipelined partial tail", uint64_t{COMMANDS / 2} * ROUNDS, [&]() {
+            std::vector<std::string_view> tokens;
+            for (int r = 0; r < ROUNDS; ++r) {
+                std::string_view buffer = partial;
+                size_t consumed = 0;
+                while (!buffer.empty() && Command::parseResp(buffer, consumed, tokens) ==
+                                              Command::ParseResult::Ok) {
+                    buffer.remove_prefix(consumed);
+                }
+                doNotOptimize(buffer);
+            }
+        });
+    }
+
+    void benchRingBuffer(Runner& runner) {
+        constexpr uint64_t OPS = 1000000;
+        std::string chunk(256, 'x');
+
+        // 块大小整除容量，数据不会跨越缓冲区末尾
+        runner.run("RingBuffer/write+peek+consume contiguous", OPS, [&]() {
+            RingBuffer rb(4096);
+            for (uint64_t i = 0; i < OPS; ++i) {
+                rb.write(chunk.data(), chunk.size());
+                doNotOptimize(rb.peek(0, chunk.size()));
+                rb.consume(chunk.size());
+            }
+        });
+
+        // 保留一段未消费数据，使读写位置持续回绕
+        std::string odd(700, 'y');
+        runner.run("RingBuffer/write+peek+consume wrap-around", OPS, [&]() {
+            RingBuffer rb(4096);
+            rb.write(odd.data(), 100);
+            for (uint64_t i = 0; i < OPS; ++i) {
+                rb.write(odd.data(), odd.size());
+                doNotOptimize(rb.peek(0, rb.size()));
+                rb.consume(odd.size());
+            }
+        });
+
+        // 从默认容量开始不断写入，覆盖扩容路径
+        constexpr uint64_t GROW_ROUNDS = 1000;
+        constexpr uint64_t WRITES_PER_ROUND = 4096;  // 每轮写入 1 MB
+        runner.run("RingBuffer/write with resize (to 1MB)", GROW_ROUNDS * WRITES_PER_ROUND, [&]() {
+            for (uint64_t r = 0; r < GROW_ROUNDS; ++r) {
+                RingBuffer rb;
+                for (uint64_t i = 0; i < WRITES_PER_ROUND; ++i) {
+                    rb.write(chunk.data(), chunk.size());
+                }
+                doNotOptimize(rb.size());
+            }
+        });
+    }
+
+    void benchHotKeys(Runner& runner) {
+        constexpr uint64_t OPS = 1000000;
+        std::vector<std::string> keys;
+        for (int i = 0; i < 10000; ++i) {
+            keys.push_back("key:" + std::to_string(i));
+        }
+        auto& hotkeys = HotKeys::getInstance();
+
+        // 默认采样率下命令路径上的实际开销
+        runner.run("HotKeys::touch (default sample rate)", OPS, [&]() {
+            for (uint64_t i = 0; i < OPS; ++i) {
+                hotkeys.touch(keys[i % keys.size()]);
+            }
+        });
+
+        // 每次访问都进入 sketch 与 top-K 堆
+        runner.run("HotKeys::touch (sample every access)", OPS, [&]() {
+            uint64_t rate = hotkeys.sampleRate();
+            hotkeys.setSampleRate(1);
+            for (uint64_t i = 0; i < OPS; ++i) {
+                hotkeys.touch(keys[i % keys.size()]);
+            }
+            hotkeys.setSampleRate(rate);
+        });
+        hotkeys.reset();
+    }
+
+    void benchValue(Runner& runner) {
+        constexpr uint64_t OPS = 2000;
+        // 约 16KB 的 JSON 数组，与线上常见的大 value 类似
+        std::string json = "[";
+        for (int i = 0; json.size() < 16 * 1024; ++i) {
+            json += "{\"id\":" + std::to_string(i * 7919 % 100000) + ",\"name\":\"user" +
+                    std::to_string(i) + "\",\"email\":\"user" + std::to_string(i) +
+                    "@example.com\",\"active\":" + (i % 3 ? "true" : "false") + "},";
+        }
+        json.back() = ']';
+        std::string random(json.size(), '\0');
+        std::mt19937_64 rng(42);
+        for (auto& c : random) {
+            c = static_cast<char>(rng());
+        }
+
+        runner.run("Value::make/16KB JSON (compress)", OPS, [&]() {
+            for (uint64_t i = 0; i < OPS; ++i) {
+                doNotOptimize(Value::make(json, 1024).storedSize());
+            }
+        });
+        // 不可压缩的数据应当很快放弃
+        runner.run("Value::make/16KB random (rejected)", OPS, [&]() {
+            for (uint64_t i = 0; i < OPS; ++i) {
+                doNotOptimize(Value::make(random, 1024).storedSize());
+            }
+        });
+        Value value = Value::make(json, 1024);
+        runner.run("Value::str/16KB JSON (decompress)", OPS, [&]() {
+            for (uint64_t i = 0; i < OPS; ++i) {
+                doNotOptimize(value.str());
+            }
+        });
+    }
+
+    void benchStore(Runner& runner, const Options& opts, uint64_t keys) {
+        std::string scale = std::to_string(keys);
+        std::string value(opts.value_size, 'v');
+        std::vector<std::string> names;
+        names.reserve(keys);
+        for (uint64_t i = 0; i < keys; ++i) {
+            names.push_back(makeKey(i));
+        }
+        std::mt19937_64 rng(42);
+        std::vector<uint32_t> order(keys);
+        for (auto& idx : order) {
+            idx = static_cast<uint32_t>(rng() % keys);
+        }
+
+        auto aof = tempAof("store-" + scale);
+        {
+            Store store(aof.string());
+            runner.setup("Store::set/" + scale + " keys (insert)", keys, [&]() {
+                for (uint64_t i = 0; i < keys; ++i) {
+                    store.set(names[i], value);
+                }
+            });
+            runner.run("Store::set/" + scale + " keys (overwrite)", keys, [&]() {
+                for (uint64_t i = 0; i < keys; ++i) {
+                    store.set(names[order[i]], value);
+                }
+            });
+            runner.run("Store::get/" + scale + " keys (hit)", keys, [&]() {
+                for (uint64_t i = 0; i < keys; ++i) {
+                    doNotOptimize(store.get(names[order[i]]));
+                }
+            });
+            runner.run("Store::get/" + scale + " keys (miss)", keys, [&]() {
+                std::string missing = "missing:0000000000";
+                for (uint64_t i = 0; i < keys; ++i) {
+                    missing.back() = static_cast<char>('0' + i % 10);
+                    doNotOptimize(store.get(missing));
+                }
+            });
+            runner.run("Store::scan/" + scale + " keys (COUNT 100)", keys, [&]() {
+                std::vector<std::string> batch;
+                uint64_t cursor = 0;
+                do {
+                    batch.clear();
+                    cursor = store.scan(cursor, 100, "key:*", batch);
+                    doNotOptimize(batch);
+                } while (cursor != 0);
+            });
+            runner.run("Store::setExpire/" + scale + " keys", keys, [&]() {
+                for (uint64_t i = 0; i < keys; ++i) {
+                    store.setExpire(names[i], 3600);
+                }
+            });
+            runner.run("Store::cleanupExpiredKeys/" + scale + " keys (none due)", keys,
+                       [&]() { store.cleanupExpiredKeys(); });
+
+            // EXPIRE 的最小粒度为 1 秒，等待全部过期后再测删除路径
+            std::string name = "Store::cleanupExpiredKeys/" + scale + " keys (all due)";
+            if (runner.enabled(name)) {
+                for (uint64_t i = 0; i < keys; ++i) {
+                    store.setExpire(names[i], 1);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+                runner.run(name, keys, [&]() { store.cleanupExpiredKeys(); });
+            }
+        }
+        std::filesystem::remove(aof);
+    }
+
+    void benchAof(Runner& runner, const Options& opts) {
+        uint64_t commands = std::min<uint64_t>(opts.max_keys, 1000000);
+        std::string value(opts.value_size, 'v');
+        std::vector<std::string> names;
+        names.reserve(commands);
+        for (uint64_t i = 0; i < commands; ++i) {
+            names.push_back(makeKey(i));
+        }
+
+        std::string log_name = "Store::logCommand/SET " + std::to_string(opts.value_size) + "B";
+        std::string replay_name = "AOF replay/" + std::to_string(commands) + " commands";
+        if (!runner.enabled(log_name) && !runner.enabled(replay_name)) {
+            return;
+        }
+
+        auto aof = tempAof("aof");
+        {
+            Store store(aof.string());
+            runner.setup(log_name, commands, [&]() {
+                for (uint64_t i = 0; i < commands; ++i) {
+                    store.logCommand({"SET", names[i], value});
+                }
+            });
+        }
+        if (std::filesystem::exists(aof) && std::filesystem::file_size(aof) > 0) {
+            runner.run(replay_name, commands, [&]() {
+                Store store(aof.string());
+                doNotOptimize(&store);
+            });
+        }
+        std::filesystem::remove(aof);
+    }
+
+    void usage() {
+        std::cerr << "Usage: mini-redis-microbench [options]\n"
+                     "  --filter <substr>  only run benchmarks whose name contains substr\n"
+                     "  --max-keys <n>     largest Store scale, 1K..10M (default 1000000)\n"
+                     "  -d <size>          value size in bytes (default 64)\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + std::string(arg));
+            }
+            std::string value = argv[++i];
+            if (arg == "--filter") {
+                opts.filter = value;
+            } else if (arg == "--max-keys") {
+                opts.max_keys = std::stoull(value);
+            } else if (arg == "-d") {
+                opts.value_size = std::stoull(value);
+            } else {
+                throw std::invalid_argument("unknown option " + std::string(arg));
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        usage();
+        return 1;
+    }
+
+    try {
+        Runner runner(opts);
+        benchParser(runner, opts);
+        benchRingBuffer(runner);
+        benchHotKeys(runner);
+        benchValue(runner);
+        for (uint64_t keys = 1000; keys <= opts.max_keys && keys <= 10000000; keys *= 10) {
+            benchStore(runner, opts, keys);
+        }
+        benchAof(runner, opts);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
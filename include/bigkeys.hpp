@@ -0,0 +1,52 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "store.hpp"
+
+/**
+ * 大键分析：由定时任务按游标增量遍历键空间，记录 value 最大的若干个键
+ *
+ * 每次 step 在 deadline 前返回，不会长时间阻塞请求处理；遍历期间键空间可以正常修改，
+ * 结果是一个近似快照（遍历开始后写入的大 value 可能不在其中）。
+ */
+class BigKeys {
+public:
+    enum class State { Idle, Running, Done };
+
+    static BigKeys& getInstance();
+
+    // 开始新一轮分析，保留 value 最大的 top 个键
+    void start(size_t top);
+    void stop();
+    // 定时任务调用，推进遍历直到 deadline 或遍历结束
+    void step(const Store& store, std::chrono::steady_clock::time_point deadline);
+
+    bool running() const { return state_ == State::Running; }
+    State state() const { return state_; }
+    uint64_t scannedKeys() const { return scanned_keys_; }
+    uint64_t totalBytes() const { return total_bytes_; }
+    // 按 value 大小从大到小排列
+    std::vector<std::pair<std::string, size_t>> biggest() const;
+
+    static constexpr size_t DEFAULT_TOP{10};
+    static constexpr size_t MAX_TOP{1000};
+
+private:
+    BigKeys() = default;
+
+    void scanBatch(const Store& store);
+
+    // 每访问这么多个键检查一次 deadline
+    static constexpr size_t STEP_KEYS{1000};
+
+    State state_{State::Idle};
+    uint64_t cursor_{0};
+    size_t top_{DEFAULT_TOP};
+    uint64_t scanned_keys_{0};
+    uint64_t total_bytes_{0};
+    std::vector<std::pair<size_t, std::string>> heap_;  // 按 value 大小的最小堆
+};
@@ -1,14 +1,69 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "reply_buffer.hpp"
 #include "ring_buffer.hpp"
 
 struct Client {
+    uint64_t id{0};  // 连接建立时由 Server 分配，CLIENT ID / TRACKING REDIRECT 使用
+    int fd{-1};
+    int resp{2};  // 协议版本，HELLO 3 后为 3，可以接收推送消息
+
     RingBuffer buffer;
-    std::string response;
-    bool has_pending_write{false};
+    ReplyBuffer response;
+    bool has_pending_write{false};  // 水平触发模式下是否已注册 EPOLLOUT
+    bool read_queued{false};        // 是否在 Server 的待读取队列中
+    bool write_queued{false};       // 是否在 Server 的待发送队列中
+    bool close_after_reply{false};  // 协议错误：不再读取与执行命令，已有响应发完后关闭连接
+    // 下一条命令要读的冷 value 还在读盘：命令留在读缓冲区中，由 Server 之后重新执行
+    bool waiting_for_disk{false};
+    std::chrono::steady_clock::time_point disk_wait_since;
+    // 正在发送的大响应累计在 sendmsg 中花费的时间，发完后作为一个 large-reply 样本记录
+    bool large_reply{false};
+    std::chrono::steady_clock::duration large_reply_time{};
+    std::chrono::steady_clock::time_point last_interaction;  // 最近一次收到数据，用于空闲超时
+    // 连接关闭时 Server 事件循环的轮次，reset 不清除：同一轮 epoll_wait 返回的剩余事件
+    // 都属于已关闭的旧连接，即使槽位已被新连接复用也要丢弃
+    uint64_t closed_iteration{0};
 
     bool in_transaction{false};  // 事务状态
     std::vector<std::vector<std::string>> transaction_queue;
-};
\ No newline at end of file
+
+    // 客户端缓存失效跟踪（CLIENT TRACKING）
+    bool tracking{false};
+    bool tracking_bcast{false};
+    bool tracking_noloop{false};
+    uint64_t tracking_redirect{0};  // 非 0 时失效消息发往该客户端
+    std::vector<std::string> tracking_prefixes;
+    // 自己正在执行的命令产生的推送消息，等完整响应写入 response 后再追加，
+    // 否则会插进 EXEC 等直接写入 response 的多段回复中间
+    std::string pending_pushes;
+
+    // 连接关闭后重置状态以便复用：读缓冲区保留已分配的内存，
+    // 响应队列则整个释放，其中可能还引用着大 value，慢客户端也可能让它涨得很大
+    void reset() {
+        id = 0;
+        fd = -1;
+        resp = 2;
+        buffer.consume(buffer.size());
+        response.clear();
+        has_pending_write = false;
+        read_queued = false;
+        write_queued = false;
+        close_after_reply = false;
+        waiting_for_disk = false;
+        large_reply = false;
+        large_reply_time = {};
+        in_transaction = false;
+        transaction_queue.clear();
+        tracking = false;
+        tracking_bcast = false;
+        tracking_noloop = false;
+        tracking_redirect = 0;
+        tracking_prefixes.clear();
+        pending_pushes.clear();
+    }
+};
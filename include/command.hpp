@@ -14,6 +14,7 @@ class Server;
 class Command {
 public:
     virtual ~Command() = default;
+    // 返回要发送的响应；也可以直接写入 client.response（之前的响应此时都已写入），并返回空字符串
     virtual std::string execute(const std::vector<std::string_view>& tokens, Store& store,
                                 Client& client) = 0;
 
@@ -26,16 +27,24 @@ public:
     static void registerCommand(std::string_view name,
                                 std::function<std::unique_ptr<Command>()> creator);
 
+    // 解析结果：完整的一条命令 / 数据还不完整，需要等待更多数据 / 格式错误，无法继续解析
+    enum class ParseResult { Ok, Incomplete, Error };
+
     /**
      * 解析 Redis 序列化协议 (RESP) 格式的数组
      *
      * @param buffer 输入缓冲区，包含 RESP 格式数据
      * @param consumed 输出参数，表示成功解析消耗的字节数
      * @param result 输出参数，存储解析出的字符串元素
-     * @return bool 解析成功返回 true，失败返回 false
+     * @return ParseResult 只有返回 Ok 时 consumed 与 result 有意义
      */
-    static bool parseResp(std::string_view buffer, size_t& consumed,
-                          std::vector<std::string_view>& result);
+    static ParseResult parseResp(std::string_view buffer, size_t& consumed,
+                                 std::vector<std::string_view>& result);
+
+private:
+    // 处理事务状态并分派到具体命令，耗时由 process 统一统计
+    static std::string dispatch(const std::vector<std::string_view>& tokens, Store& store,
+                                Client& client);
 };
 
 class CommandFactory {
@@ -43,6 +52,7 @@ public:
     static CommandFactory& getInstance();
     void registerCommand(std::string_view name, std::function<std::unique_ptr<Command>()> creator);
     std::unique_ptr<Command> createCommand(std::string_view name) const;
+    bool hasCommand(std::string_view name) const { return creators_.count(name) > 0; }
 
 private:
     CommandFactory() = default;
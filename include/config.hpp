@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * 服务端配置：配置文件、命令行参数与 CONFIG GET/SET 共用同一张参数表
+ *
+ * 启动顺序为 默认值 -> 配置文件 -> 命令行 --name value，后者覆盖前者。
+ * 监听地址、端口、文件路径等只能在启动时指定；其余参数可以在运行时通过 CONFIG SET 修改，
+ * 属于 Stats、Tracking、HotKeys 的参数直接写入对应模块，监听 socket 与 Store 的参数
+ * 通过 change handler 交给 Server 处理。
+ */
+class Config {
+public:
+    struct Options {
+        std::vector<std::string> bind{"0.0.0.0"};
+        int64_t port{6379};  // 0 表示不监听 TCP
+        int64_t tcp_backlog{511};
+        bool tcp_nodelay{true};
+        int64_t tcp_keepalive{300};  // 秒，0 表示关闭
+        int64_t so_sndbuf{0};        // 字节，0 表示使用系统默认值
+        int64_t so_rcvbuf{0};
+        std::string unixsocket;  // 为空时不监听 Unix domain socket
+        int64_t unixsocketperm{0};
+        int64_t timeout{0};  // 客户端空闲超时（秒），0 表示不限制
+        int64_t maxclients{10000};
+        bool epoll_edge_triggered{false};
+        int64_t hz{10};      // 定时任务每秒触发次数
+        std::string dir{"."};
+        std::string appendfilename{"aof.log"};
+        std::string appendfsync{"everysec"};  // always / everysec / no
+        bool lazyfree_lazy_expire{true};
+        bool lazyfree_lazy_server_del{true};
+        bool lazyfree_lazy_user_del{false};
+        bool value_compression{false};
+        int64_t value_compression_threshold{4096};
+        bool tiered_storage{false};
+        std::string tiered_storage_path{"values"};  // 段文件路径前缀，相对于 dir
+        int64_t tiered_max_memory{1024LL * 1024 * 1024};
+        int64_t tiered_min_value_size{1024};
+        int64_t tiered_compact_garbage_ratio{50};  // 百分比
+    };
+
+    static Config& getInstance();
+
+    const Options& options() const { return options_; }
+
+    /**
+     * 解析命令行：mini-redis [配置文件] [--name value ...]
+     *
+     * 出错时抛出 std::runtime_error
+     */
+    void parseArgs(int argc, char* argv[]);
+    // 读取配置文件，每行为 "name value ..."，# 开头的行为注释；出错时抛出 std::runtime_error
+    void loadFile(const std::string& path);
+
+    /**
+     * 修改一组参数：先校验全部参数，都合法后才依次生效，任何一个失败时不修改任何参数
+     *
+     * @param pairs name/value 对，value 可以包含多个以空格分隔的值（如 bind）
+     * @param startup 启动阶段为 true，此时允许修改只读参数且不触发 change handler
+     * @return std::string 成功返回空字符串，否则为错误信息
+     */
+    std::string set(const std::vector<std::pair<std::string, std::string>>& pairs, bool startup);
+    // CONFIG GET：返回名字匹配 glob 模式的参数
+    std::vector<std::pair<std::string, std::string>> get(std::string_view pattern) const;
+
+    // 运行时参数修改成功后的回调，参数为参数名
+    void setChangeHandler(std::function<void(std::string_view)> handler) {
+        on_change_ = std::move(handler);
+    }
+
+private:
+    Config();
+
+    struct Param {
+        bool mutable_at_runtime;
+        std::function<std::string()> get;
+        // 只校验 value，不修改任何状态：成功时返回空字符串并通过 apply 返回生效操作，
+        // 否则为错误信息
+        std::function<std::string(std::string_view, std::function<void()>& apply)> parse;
+    };
+
+    void addParam(const std::string& name, bool runtime, std::function<std::string()> get,
+                  std::function<std::string(std::string_view, std::function<void()>&)> parse);
+    void addBool(const std::string& name, bool& field, bool runtime);
+    void addInt(const std::string& name, std::function<int64_t()> get,
+                std::function<void(int64_t)> set, int64_t min, int64_t max, bool runtime);
+    void addInt(const std::string& name, int64_t& field, int64_t min, int64_t max, bool runtime);
+    // 字节数，接受 k/kb/m/mb/g/gb 后缀，取值范围为 [0, max]
+    void addMemory(const std::string& name, int64_t& field, int64_t max, bool runtime);
+    void addString(const std::string& name, std::string& field, bool runtime);
+
+    Options options_;
+    std::map<std::string, Param, std::less<>> params_;
+    std::function<void(std::string_view)> on_change_;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * 基于 timerfd 的定时任务调度
+ *
+ * timerfd 每秒触发 hz 次并注册在事件循环的 epoll 中，空闲时事件循环可以无限期阻塞；
+ * 每个任务有自己的周期和单次执行的时间预算，任务函数拿到 deadline 后应在其之前返回，
+ * 从而把过期清理等后台工作均匀地分摊到各个时间片，而不是集中在某一次循环里。
+ */
+class Cron {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Job = std::function<void(Clock::time_point deadline)>;
+
+    // 创建 timerfd，失败时抛出 std::runtime_error
+    explicit Cron(int hz);
+    ~Cron();
+
+    Cron(const Cron&) = delete;
+    Cron& operator=(const Cron&) = delete;
+
+    // 供事件循环注册到 epoll
+    int fd() const { return timer_fd_; }
+
+    int hz() const { return hz_; }
+    void setHz(int hz);
+
+    /**
+     * 注册周期任务
+     *
+     * @param name 任务名，同时作为 LATENCY 事件名和 INFO cron 统计的名字
+     * @param period 执行周期，实际精度为 1000/hz 毫秒，小于该值时每个时间片都执行
+     * @param budget 单次执行的时间预算
+     */
+    void addJob(std::string name, std::chrono::milliseconds period,
+                std::chrono::microseconds budget, Job fn);
+
+    // timerfd 可读时调用，执行所有到期的任务
+    void onTimer();
+
+private:
+    struct Entry {
+        std::string name;
+        std::chrono::milliseconds period;
+        std::chrono::microseconds budget;
+        Job fn;
+        Clock::time_point next_run;
+    };
+
+    int timer_fd_{-1};
+    int hz_;
+    std::vector<Entry> jobs_;
+};
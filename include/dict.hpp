@@ -0,0 +1,221 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * 键为字符串的链式哈希表，bucket 数量始终为 2 的幂
+ *
+ * 与 std::unordered_map 相比，bucket 下标就是 hash & mask，因此可以提供
+ * Redis 风格的 reverse-binary 游标遍历：两次 scan 调用之间表扩容或缩容，
+ * 遍历开始前已存在且未被删除的键仍保证至少返回一次。
+ * 查找接受 std::string_view，避免为每次查询构造临时 std::string。
+ */
+template <typename V>
+class Dict {
+public:
+    struct Entry {
+        Entry(std::string_view k, V v) : key(k), value(std::move(v)) {}
+
+        std::string key;
+        V value;
+        Entry* next{nullptr};
+    };
+
+    Dict() = default;
+    ~Dict() { clear(); }
+
+    Dict(const Dict&) = delete;
+    Dict& operator=(const Dict&) = delete;
+
+    Dict(Dict&& other) noexcept : buckets_(std::move(other.buckets_)), size_(other.size_) {
+        other.buckets_.clear();
+        other.size_ = 0;
+    }
+
+    Dict& operator=(Dict&& other) noexcept {
+        if (this != &other) {
+            clear();
+            buckets_ = std::move(other.buckets_);
+            size_ = other.size_;
+            other.buckets_.clear();
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t bucketCount() const { return buckets_.size(); }
+
+    V* find(std::string_view key) {
+        Entry* entry = findEntry(key);
+        return entry ? &entry->value : nullptr;
+    }
+
+    const V* find(std::string_view key) const {
+        const Entry* entry = const_cast<Dict*>(this)->findEntry(key);
+        return entry ? &entry->value : nullptr;
+    }
+
+    // 查找 key，不存在时插入默认构造的 value；second 表示是否为新插入
+    std::pair<Entry*, bool> insert(std::string_view key) {
+        if (Entry* entry = findEntry(key)) {
+            return {entry, false};
+        }
+        if (size_ >= buckets_.size()) {
+            rehash(buckets_.empty() ? INITIAL_BUCKETS : buckets_.size() * 2);
+        }
+        auto* entry = new Entry(key, V{});
+        size_t idx = hash(key) & mask();
+        entry->next = buckets_[idx];
+        buckets_[idx] = entry;
+        ++size_;
+        return {entry, true};
+    }
+
+    // 从表中摘下 key 对应的节点并交出所有权，不存在时返回 nullptr
+    std::unique_ptr<Entry> unlink(std::string_view key) {
+        if (buckets_.empty()) {
+            return nullptr;
+        }
+        Entry** link = &buckets_[hash(key) & mask()];
+        while (*link) {
+            Entry* entry = *link;
+            if (entry->key == key) {
+                *link = entry->next;
+                entry->next = nullptr;
+                --size_;
+                maybeShrink();
+                return std::unique_ptr<Entry>(entry);
+            }
+            link = &entry->next;
+        }
+        return nullptr;
+    }
+
+    bool erase(std::string_view key) { return unlink(key) != nullptr; }
+
+    void clear() {
+        for (Entry*& head : buckets_) {
+            while (head) {
+                Entry* next = head->next;
+                delete head;
+                head = next;
+            }
+        }
+        buckets_.clear();
+        size_ = 0;
+    }
+
+    // 遍历全部节点：fn(const std::string& key, const V& value)
+    template <typename F>
+    void forEach(F&& fn) const {
+        for (const Entry* head : buckets_) {
+            for (const Entry* entry = head; entry; entry = entry->next) {
+                fn(entry->key, entry->value);
+            }
+        }
+    }
+
+    /**
+     * 访问游标 cursor 指向的一个 bucket 中的全部节点，返回下一个游标，返回 0 表示遍历结束
+     *
+     * 游标按 bucket 下标的反转二进制位递增，因此表大小在两次调用之间翻倍或减半时，
+     * 已访问过的 bucket 在新表中对应的下标都小于新游标，不会漏掉键（可能重复）。
+     */
+    template <typename F>
+    uint64_t scan(uint64_t cursor, F&& fn) const {
+        if (buckets_.empty()) {
+            return 0;
+        }
+        uint64_t m = mask();
+        for (const Entry* entry = buckets_[cursor & m]; entry; entry = entry->next) {
+            fn(entry->key, entry->value);
+        }
+        return nextCursor(cursor, m);
+    }
+
+    // 同上，fn(const std::string& key, V& value) 可以修改 value，但不能增删节点
+    template <typename F>
+    uint64_t scan(uint64_t cursor, F&& fn) {
+        if (buckets_.empty()) {
+            return 0;
+        }
+        uint64_t m = mask();
+        for (Entry* entry = buckets_[cursor & m]; entry; entry = entry->next) {
+            fn(entry->key, entry->value);
+        }
+        return nextCursor(cursor, m);
+    }
+
+private:
+    static constexpr size_t INITIAL_BUCKETS{4};
+
+    static size_t hash(std::string_view key) { return std::hash<std::string_view>{}(key); }
+
+    static uint64_t reverseBits(uint64_t v) {
+        v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+        v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+        v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        v = ((v >> 8) & 0x00FF00FF00FF00FFULL) | ((v & 0x00FF00FF00FF00FFULL) << 8);
+        v = ((v >> 16) & 0x0000FFFF0000FFFFULL) | ((v & 0x0000FFFF0000FFFFULL) << 16);
+        return (v >> 32) | (v << 32);
+    }
+
+    // 把高于 mask 的位全部置 1 后对反转的值加 1，相当于从高位开始进位
+    static uint64_t nextCursor(uint64_t cursor, uint64_t m) {
+        cursor |= ~m;
+        cursor = reverseBits(cursor);
+        ++cursor;
+        return reverseBits(cursor);
+    }
+
+    size_t mask() const { return buckets_.size() - 1; }
+
+    Entry* findEntry(std::string_view key) {
+        if (buckets_.empty()) {
+            return nullptr;
+        }
+        for (Entry* entry = buckets_[hash(key) & mask()]; entry; entry = entry->next) {
+            if (entry->key == key) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+    // 负载因子低于 1/8 时缩容，避免大量删除后 scan 空转
+    void maybeShrink() {
+        if (buckets_.size() > INITIAL_BUCKETS && size_ * 8 < buckets_.size()) {
+            size_t target = INITIAL_BUCKETS;
+            while (target < size_) {
+                target *= 2;
+            }
+            rehash(target);
+        }
+    }
+
+    void rehash(size_t bucket_count) {
+        std::vector<Entry*> buckets(bucket_count, nullptr);
+        size_t m = bucket_count - 1;
+        for (Entry* head : buckets_) {
+            while (head) {
+                Entry* next = head->next;
+                size_t idx = hash(head->key) & m;
+                head->next = buckets[idx];
+                buckets[idx] = head;
+                head = next;
+            }
+        }
+        buckets_.swap(buckets);
+    }
+
+    std::vector<Entry*> buckets_;
+    size_t size_{0};
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include <string_view>
+
+/**
+ * Redis 风格的 glob 匹配：支持 *、?、[abc]、[^a-z] 以及 \ 转义
+ *
+ * 采用单次回溯（只记录最近一个 * 的位置）的迭代实现，不递归，
+ * 常见模式下为线性时间。
+ */
+bool globMatch(std::string_view pattern, std::string_view str);
+
+// 模式中不含通配符时返回 true，调用方可以改为精确查找
+bool globIsLiteral(std::string_view pattern);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * HDR 风格的对数-线性延迟直方图
+ *
+ * 每个 2 的幂区间内再线性划分 64 个子桶，相对误差不超过 1/64，
+ * 记录操作只是一次下标计算加一次自增，可以在热路径上常驻。
+ * 数值单位由调用方决定（benchmark 与服务端统计均使用微秒）。
+ */
+class Histogram {
+public:
+    Histogram();
+
+    void record(uint64_t value);
+    void merge(const Histogram& other);
+    void reset();
+
+    // 返回第 p 百分位（0~100）所在桶的上界
+    uint64_t percentile(double p) const;
+
+    uint64_t count() const { return count_; }
+    uint64_t sum() const { return sum_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+private:
+    static constexpr int SUB_BUCKET_BITS{7};
+    static constexpr uint64_t SUB_BUCKET_COUNT{1u << SUB_BUCKET_BITS};
+    static constexpr uint64_t SUB_BUCKET_HALF{SUB_BUCKET_COUNT / 2};
+    static constexpr size_t BUCKET_COUNT{SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF};
+
+    static size_t indexOf(uint64_t value);
+    static uint64_t highestEquivalent(size_t index);
+
+    std::array<uint64_t, BUCKET_COUNT> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
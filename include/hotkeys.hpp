@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * 热点键探测：对命令访问的键随机采样，计入 count-min sketch，并用最小堆维护估计次数最高的 K 个键
+ *
+ * 未被采样的访问只做一次 xorshift 随机数运算，因此可以常驻开启。sketch 的计数在采样数
+ * 达到 DECAY_INTERVAL 时整体减半，结果反映的是近期热度而不是启动以来的累计值。
+ */
+class HotKeys {
+public:
+    struct Item {
+        std::string key;
+        uint64_t count;  // sketch 中的估计采样次数
+    };
+
+    static HotKeys& getInstance();
+
+    // 命令访问了 key，按采样率决定是否计入
+    void touch(std::string_view key) {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 7;
+        rng_ ^= rng_ << 17;
+        if ((rng_ & sample_mask_) == 0) {
+            sample(key);
+        }
+    }
+
+    // 按估计访问次数从高到低返回至多 count 个键，次数已按采样率换算
+    std::vector<std::pair<std::string, uint64_t>> top(size_t count) const;
+    void reset();
+
+    // 每 rate 次访问采样一次，rate 向上取整为 2 的幂
+    void setSampleRate(uint64_t rate);
+    uint64_t sampleRate() const { return sample_mask_ + 1; }
+    uint64_t sampledAccesses() const { return sampled_; }
+
+    static constexpr size_t TOP_K{32};
+
+private:
+    HotKeys();
+
+    static constexpr size_t SKETCH_DEPTH{4};
+    static constexpr size_t SKETCH_WIDTH{4096};  // 必须为 2 的幂
+    static constexpr uint64_t DEFAULT_SAMPLE_RATE{8};
+    static constexpr uint64_t DECAY_INTERVAL{1 << 16};
+
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    void sample(std::string_view key);
+    // conservative update：只增加等于当前最小值的计数器，返回新的估计值
+    uint32_t increment(std::string_view key);
+    void decay();
+
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+    void swapItems(size_t a, size_t b);
+
+    std::vector<uint32_t> sketch_;  // SKETCH_DEPTH 行，每行 SKETCH_WIDTH 个计数器
+    std::vector<Item> heap_;        // 按 count 的最小堆，堆顶是 top-K 中最冷的键
+    std::unordered_map<std::string, size_t, StringHash, std::equal_to<>> index_;  // key -> 堆下标
+
+    uint64_t rng_{0x9E3779B97F4A7C15ULL};
+    uint64_t sample_mask_{DEFAULT_SAMPLE_RATE - 1};
+    uint64_t sampled_{0};
+    uint64_t since_decay_{0};
+};
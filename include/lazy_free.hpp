@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * 后台释放线程
+ *
+ * 事件循环只负责把待释放对象（大 value、摘下的哈希节点、整张表）移交进来，
+ * 真正的析构与 free() 在后台线程完成，避免大对象析构阻塞事件循环。
+ */
+class LazyFree {
+public:
+    LazyFree();
+    ~LazyFree();
+
+    LazyFree(const LazyFree&) = delete;
+    LazyFree& operator=(const LazyFree&) = delete;
+
+    // 接管 object 的所有权并在后台线程析构；objects 为其中包含的对象数，仅用于统计
+    template <typename T>
+    void free(T&& object, size_t objects = 1) {
+        enqueue(std::make_unique<Holder<std::decay_t<T>>>(std::forward<T>(object)), objects);
+    }
+
+    size_t pendingObjects() const { return pending_objects_.load(std::memory_order_relaxed); }
+    size_t freedObjects() const { return freed_objects_.load(std::memory_order_relaxed); }
+
+private:
+    struct Garbage {
+        virtual ~Garbage() = default;
+        size_t objects{1};
+    };
+
+    template <typename T>
+    struct Holder : Garbage {
+        explicit Holder(T&& v) : value(std::move(v)) {}
+        T value;
+    };
+
+    void enqueue(std::unique_ptr<Garbage> garbage, size_t objects);
+    void loop();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<Garbage>> queue_;
+    bool stop_{false};
+
+    std::atomic<size_t> pending_objects_{0};
+    std::atomic<size_t> freed_objects_{0};
+
+    std::thread worker_;
+};
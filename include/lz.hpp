@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * 内置的 LZ77 块压缩，格式与 LZ4 block 相近
+ *
+ * 每个序列为：token（高 4 位字面量长度、低 4 位匹配长度 - 4，取 15 时后接 255 累加的扩展长度）、
+ * 字面量、2 字节小端偏移、扩展匹配长度；最后一个序列只有字面量。
+ * 压缩使用 4096 项的哈希表查找 4 字节匹配，连续未命中时逐渐加大步长，不可压缩的数据也很快返回。
+ */
+
+// 解压后与压缩数据的长度之比的上限：匹配至少占 3 字节（token 与偏移），
+// 之后每个扩展长度字节最多再表示 255 字节
+constexpr size_t LZ_MAX_RATIO{255};
+
+// 压缩结果超过 max_size 字节时放弃并返回 false，out 的内容此时无意义
+bool lzCompress(std::string_view in, size_t max_size, std::string& out);
+
+// 解压到 out，输入损坏或解压后的长度不等于 out_size 时返回 false，不会越界读写
+bool lzDecompress(std::string_view in, char* out, size_t out_size);
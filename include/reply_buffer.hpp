@@ -0,0 +1,55 @@
+#pragma once
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "shared_buffer.hpp"
+
+/**
+ * 客户端的待发送响应队列
+ *
+ * 小响应拷贝进 16KB 左右的块中；较大的 value 只保存 SharedBuffer 引用，
+ * 发送时与前后的协议头一起通过 iovec 交给 sendmsg，value 本身不经过任何拷贝。
+ */
+class ReplyBuffer {
+public:
+    bool empty() const { return size_ == 0; }
+    // 待发送的字节数
+    size_t size() const { return size_; }
+    // 拷贝块占用的内存
+    size_t capacity() const;
+
+    void append(std::string_view data);
+    // 小于 REFERENCE_THRESHOLD 时拷贝，否则排队一个引用，发送完成前 data 不会被释放
+    void append(SharedBuffer data);
+
+    // 按顺序把待发送的数据填入 iov，返回填入的个数
+    int prepare(iovec* iov, int max_iov) const;
+    // 移除已发送的 bytes 字节
+    void consume(size_t bytes);
+    // 丢弃所有数据并释放内存
+    void clear();
+
+    static constexpr size_t REFERENCE_THRESHOLD{4 * 1024};
+
+private:
+    struct Chunk {
+        std::string copied;
+        SharedBuffer shared;  // 非空时为引用块，copied 不使用
+        size_t sent{0};       // 已发送的字节数
+
+        std::string_view pending() const {
+            std::string_view data = shared.size() ? shared.view() : std::string_view(copied);
+            return sent < data.size() ? data.substr(sent) : std::string_view();
+        }
+    };
+
+    static constexpr size_t CHUNK_SIZE{16 * 1024};
+
+    std::vector<Chunk> chunks_;
+    size_t head_{0};  // 第一个未发送完的块
+    size_t size_{0};
+};
@@ -8,11 +8,19 @@ public:
     RingBuffer(size_t capacity = 1024);
     ~RingBuffer();
 
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+    // A moved-from buffer is empty with capacity 0 and stays usable: the next write reallocates
+    RingBuffer(RingBuffer&& other) noexcept;
+    RingBuffer& operator=(RingBuffer&& other) noexcept;
+
     // Write data to the buffer
     bool write(const char* data, size_t len);
 
-    // Read data into a string_view without removing it
-    std::string_view peek(size_t offset, size_t len) const;
+    // Read data into a string_view without removing it.
+    // If the range wraps around, the buffer is linearized first so the view stays valid
+    // until the next write/consume.
+    std::string_view peek(size_t offset, size_t len);
 
     // Consume (remove) data from the buffer
     void consume(size_t len);
@@ -23,6 +31,11 @@ public:
     // Get available space for writing
     size_t available() const;
 
+    size_t capacity() const { return capacity_; }
+
+    // Shrink the buffer to max(min_capacity, size() + 1) bytes, keeping the data
+    void shrink(size_t min_capacity);
+
 private:
     char* buffer_;
     size_t capacity_;
@@ -31,4 +44,7 @@ private:
 
     // Resize buffer if needed
     void resize(size_t new_capacity);
+
+    // Move data to the start of the buffer so it is contiguous
+    void linearize();
 };
\ No newline at end of file
@@ -1,37 +1,107 @@
 #pragma once
 #include <sys/epoll.h>
 
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "client.hpp"
 #include "command.hpp"
+#include "config.hpp"
+#include "cron.hpp"
 #include "store.hpp"
 
 class Server {
 public:
     using time_point = std::chrono::system_clock::time_point;
 
-    Server(int port, const std::string& aof_file);
+    // 按 config 创建 TCP 与 Unix domain socket 监听，失败时抛出 std::runtime_error
+    explicit Server(Config& config);
     ~Server();
     void run();
 
 private:
-    void setNonBlocking(int fd);
-    void handleNewConnection();
-    void handleClientEvent(int client_fd, uint32_t events);
-    void closeClient(int client_fd);
+    struct Listener {
+        int fd;
+        bool unix_socket;
+    };
 
-    int server_fd_;
-    int epoll_fd_;
+    // 一次读写的结果：数据已读完/发完（EAGAIN）、达到单次上限、连接已关闭
+    enum class IoResult { Drained, Capped, Closed };
+
+    void listenTcp(const std::string& addr, int port);
+    void listenUnix(const std::string& path, int perm);
+    const Listener* findListener(const void* ptr) const;
+    // 为新建立的 TCP 连接设置 TCP_NODELAY、keepalive 与收发缓冲区
+    void configureTcpClient(int fd);
+    // 按 maxclients 调整 RLIMIT_NOFILE
+    void adjustOpenFilesLimit();
+    // CONFIG SET 修改了运行时参数
+    void onConfigChange(std::string_view name);
+    void applyAofFsync();
+
+    // 注册定时任务
+    void scheduleJobs();
+    // 从 cursor 开始遍历连接，到达 deadline 时停下，下次从停下的位置继续
+    template <typename F>
+    void forEachClient(size_t& cursor, Cron::Clock::time_point deadline, F&& fn);
+    // 关闭空闲超过 timeout 秒的连接
+    void closeIdleClients(Cron::Clock::time_point deadline);
+    // 释放空闲连接上过大的读写缓冲区
+    void shrinkClientBuffers(Cron::Clock::time_point deadline);
+
+    void handleNewConnection(const Listener& listener);
+    // 取出 fd 对应的槽位，槽位中的 Client 对象在连接关闭后保留并复用
+    Client& acquireClient(int fd);
+    void handleClientEvent(Client& client, uint32_t events);
+    IoResult readFromClient(Client& client);
+    // 分层存储：执行一批流水线命令前，为其中读取已换出 value 的 GET 发起异步预读
+    void prefetchColdValues(Client& client);
+    // 执行读缓冲区中完整的命令，遇到协议错误或要等待冷 value 读盘时停下
+    void processInput(Client& client);
+    IoResult writeToClient(Client& client);
+    void closeClient(Client& client);
+    // 边缘触发模式下读取达到上限的连接不会再收到可读事件，需要在下一轮循环继续读
+    void queueRead(Client& client);
+    // 响应缓冲区非空的连接，在本轮事件处理完、下次 epoll_wait 之前统一发送
+    void queueWrite(Client& client);
+    void handlePendingIo();
+    // 水平触发模式下注册或取消 EPOLLOUT
+    bool setWritable(Client& client, bool writable);
+
+    Config& config_;
+    std::vector<Listener> listeners_;
+    int epoll_fd_{-1};
+    bool edge_triggered_;
     Store store_;
+    Cron cron_;
 
-    std::unordered_map<int, Client> clients_;
+    // 以 fd 为下标的连接表，epoll_event.data.ptr 直接指向其中的 Client
+    std::vector<std::unique_ptr<Client>> clients_;
+    std::vector<Client*> pending_reads_;
+    std::vector<Client*> pending_writes_;
+    uint64_t next_client_id_{1};
+    uint64_t loop_iteration_{0};  // 每次 epoll_wait 返回后加一，用于识别本轮已关闭的连接
+    size_t timeout_cursor_{0};
+    size_t shrink_cursor_{0};
     static constexpr int MAX_EVENTS{128};
 
-    time_point last_cleanup_;
-    static constexpr std::chrono::seconds CLEANUP_INTERVAL{10};
+    // 每次监听 socket 可读时最多 accept 的连接数，避免连接风暴饿死已有连接
+    static constexpr int MAX_ACCEPTS_PER_CALL{1000};
+    // 单个连接每次事件最多读写的字节数
+    static constexpr size_t READ_CHUNK{16 * 1024};
+    static constexpr size_t MAX_READ_PER_EVENT{64 * 1024};
+    static constexpr size_t MAX_WRITE_PER_EVENT{64 * 1024};
+    // 每次 sendmsg 最多提交的 iovec 数
+    static constexpr int IOV_PER_WRITE{64};
+    // 待发送数据不少于该字节数时，sendmsg 的耗时记为 large-reply 延迟事件
+    static constexpr size_t LARGE_REPLY_BYTES{64 * 1024};
+    // 监听 socket、AOF、值日志当前段、epoll、timerfd 等非客户端 fd 的预留数量
+    static constexpr int RESERVED_FDS{32};
 
-    static constexpr int EPOLL_TIMEOUT_MS{1000};
-};
\ No newline at end of file
+    // 读缓冲区超过该大小且使用不到一半时缩小
+    static constexpr size_t QUERYBUF_SHRINK_THRESHOLD{32 * 1024};
+    static constexpr size_t QUERYBUF_MIN_CAPACITY{1024};
+    // 空闲连接上超过该容量的响应缓冲区直接释放
+    static constexpr size_t REPLYBUF_SHRINK_THRESHOLD{64 * 1024};
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+
+/**
+ * 不可变、带引用计数的字节缓冲区
+ *
+ * 计数与数据在同一次分配中，复制只增加引用计数。Store 中的 value 与排队等待发送的
+ * GET 响应共享同一块内存，覆盖写入只替换 Store 中的引用，已排队的响应不受影响。
+ * 引用计数是原子的，最后一个引用可以在后台释放线程中放下。
+ */
+class SharedBuffer {
+public:
+    SharedBuffer() = default;
+    ~SharedBuffer() { release(); }
+
+    SharedBuffer(const SharedBuffer& other) noexcept : header_(other.header_) { retain(); }
+    SharedBuffer(SharedBuffer&& other) noexcept : header_(other.header_) {
+        other.header_ = nullptr;
+    }
+    SharedBuffer& operator=(const SharedBuffer& other) noexcept {
+        if (header_ != other.header_) {
+            release();
+            header_ = other.header_;
+            retain();
+        }
+        return *this;
+    }
+    SharedBuffer& operator=(SharedBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            header_ = other.header_;
+            other.header_ = nullptr;
+        }
+        return *this;
+    }
+
+    static SharedBuffer copyOf(std::string_view data);
+    // 分配 size 字节的未初始化缓冲区，通过 writableData() 填充后再共享出去
+    static SharedBuffer allocate(size_t size);
+
+    const char* data() const { return header_ ? reinterpret_cast<const char*>(header_ + 1) : ""; }
+    char* writableData() { return reinterpret_cast<char*>(header_ + 1); }
+    size_t size() const { return header_ ? header_->size : 0; }
+    std::string_view view() const { return {data(), size()}; }
+    size_t useCount() const { return header_ ? header_->refs.load(std::memory_order_relaxed) : 0; }
+
+private:
+    struct Header {
+        std::atomic<size_t> refs;
+        size_t size;
+    };
+
+    void retain() {
+        if (header_) {
+            header_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    void release();
+
+    Header* header_{nullptr};
+};
@@ -0,0 +1,160 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "histogram.hpp"
+
+/**
+ * 服务端运行时统计：INFO、命令统计、SLOWLOG 与 LATENCY 的数据来源
+ *
+ * 事件循环是单线程的，所有记录接口都不加锁；记录路径只做计数和一次直方图自增，
+ * 以便统计功能可以常驻开启。
+ */
+class Stats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct CommandStat {
+        uint64_t calls{0};
+        uint64_t usec{0};
+        Histogram latency;  // 单位：微秒
+    };
+
+    struct CronStat {
+        uint64_t runs{0};
+        uint64_t usec{0};
+        uint64_t max_usec{0};
+        uint64_t over_budget{0};  // 耗时超过预算的次数
+    };
+
+    struct SlowlogEntry {
+        uint64_t id;
+        int64_t timestamp;  // unix 秒
+        uint64_t duration_us;
+        std::vector<std::string> args;
+    };
+
+    struct LatencySample {
+        int64_t timestamp;  // unix 秒
+        uint64_t msec;
+    };
+
+    struct LatencyEvent {
+        LatencySample latest{0, 0};
+        uint64_t max{0};
+        std::deque<LatencySample> history;
+    };
+
+    static Stats& getInstance();
+
+    // 命令执行完成后调用，tokens[0] 为命令名
+    void recordCommand(const std::vector<std::string_view>& tokens, uint64_t usec);
+    // 记录一次事件循环停顿，低于阈值的样本直接丢弃
+    void recordLatency(std::string_view event, uint64_t msec);
+
+    // 定时任务执行完成后调用
+    void recordCronJob(std::string_view job, uint64_t usec, bool over_budget);
+    // 由定时任务周期调用，根据计数器增量计算瞬时速率
+    void sampleInstantaneous();
+
+    void onConnect() {
+        ++connected_clients_;
+        ++total_connections_;
+    }
+    void onDisconnect() { --connected_clients_; }
+    void onRejectedConnection() { ++rejected_connections_; }
+    void onRead(size_t bytes) { net_input_bytes_ += bytes; }
+    void onWrite(size_t bytes) { net_output_bytes_ += bytes; }
+
+    void setPort(int port) { port_ = port; }
+    int port() const { return port_; }
+    int64_t uptimeSeconds() const;
+
+    uint64_t connectedClients() const { return connected_clients_; }
+    uint64_t totalConnections() const { return total_connections_; }
+    uint64_t rejectedConnections() const { return rejected_connections_; }
+    uint64_t totalCommands() const { return total_commands_; }
+    uint64_t netInputBytes() const { return net_input_bytes_; }
+    uint64_t netOutputBytes() const { return net_output_bytes_; }
+
+    // 最近若干次采样的平均值
+    uint64_t instantaneousOps() const { return ops_.average(); }
+    double instantaneousInputKbps() const { return input_.average() / 1024.0; }
+    double instantaneousOutputKbps() const { return output_.average() / 1024.0; }
+
+    const std::map<std::string, CommandStat, std::less<>>& commandStats() const {
+        return command_stats_;
+    }
+    const std::map<std::string, CronStat, std::less<>>& cronStats() const { return cron_stats_; }
+    void resetCommandStats();
+
+    const std::deque<SlowlogEntry>& slowlog() const { return slowlog_; }
+    void resetSlowlog() { slowlog_.clear(); }
+    int64_t slowlogThreshold() const { return slowlog_threshold_us_; }
+    void setSlowlogThreshold(int64_t usec) { slowlog_threshold_us_ = usec; }
+    size_t slowlogMaxLen() const { return slowlog_max_len_; }
+    void setSlowlogMaxLen(size_t len);
+
+    const std::map<std::string, LatencyEvent, std::less<>>& latencyEvents() const {
+        return latency_events_;
+    }
+    // event 为空时清除全部事件，返回被清除的事件数
+    size_t resetLatency(std::string_view event = {});
+    uint64_t latencyThreshold() const { return latency_threshold_ms_; }
+    void setLatencyThreshold(uint64_t msec) { latency_threshold_ms_ = msec; }
+
+private:
+    Stats();
+
+    // 计数器的每秒增量，保留最近 SAMPLES 次采样
+    struct RateSampler {
+        static constexpr size_t SAMPLES{16};
+
+        void sample(uint64_t value, Clock::time_point now);
+        uint64_t average() const;
+
+        uint64_t last_value{0};
+        Clock::time_point last_time{};
+        uint64_t samples[SAMPLES]{};
+        size_t index{0};
+    };
+
+    static constexpr int64_t SLOWLOG_DEFAULT_THRESHOLD_US{10000};
+    static constexpr size_t SLOWLOG_DEFAULT_MAX_LEN{128};
+    static constexpr size_t SLOWLOG_MAX_ARGC{32};
+    static constexpr size_t SLOWLOG_MAX_ARGLEN{128};
+    static constexpr uint64_t LATENCY_DEFAULT_THRESHOLD_MS{10};
+    static constexpr size_t LATENCY_HISTORY_LEN{160};
+
+    std::chrono::system_clock::time_point start_time_;
+    int port_{0};
+
+    uint64_t connected_clients_{0};
+    uint64_t total_connections_{0};
+    uint64_t rejected_connections_{0};
+    uint64_t total_commands_{0};
+    uint64_t net_input_bytes_{0};
+    uint64_t net_output_bytes_{0};
+
+    std::map<std::string, CommandStat, std::less<>> command_stats_;
+    std::map<std::string, CronStat, std::less<>> cron_stats_;
+
+    RateSampler ops_;
+    RateSampler input_;
+    RateSampler output_;
+
+    std::deque<SlowlogEntry> slowlog_;
+    uint64_t slowlog_next_id_{0};
+    int64_t slowlog_threshold_us_{SLOWLOG_DEFAULT_THRESHOLD_US};
+    size_t slowlog_max_len_{SLOWLOG_DEFAULT_MAX_LEN};
+
+    std::map<std::string, LatencyEvent, std::less<>> latency_events_;
+    uint64_t latency_threshold_ms_{LATENCY_DEFAULT_THRESHOLD_MS};
+};
@@ -1,29 +1,212 @@
 #pragma once
+#include <algorithm>
 #include <chrono>
-#include <fstream>
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "dict.hpp"
+#include "lazy_free.hpp"
+#include "value.hpp"
+#include "value_log.hpp"
+
+// 分层存储配置，path 为空表示不启用
+struct TieredOptions {
+    std::string path;                 // 段文件路径前缀
+    size_t max_memory{0};             // 内存中 value 字节数的上限，超出后换出冷 value
+    size_t min_value_size{0};         // 小于该长度的 value 不换出
+    int compact_garbage_percent{50};  // 垃圾比例不低于该百分比的段参与整理
+};
+
 class Store {
 public:
     using time_point = std::chrono::system_clock::time_point;
-    Store(const std::string& aof_file);
+
+    // AOF 刷盘策略：每条命令 fdatasync / 每秒一次 / 交给操作系统
+    enum class AofFsync { Always, EverySec, No };
+
+    // compress_threshold 非 0 时，不小于该长度的 value 尝试压缩保存（AOF 重放时同样生效）；
+    // 启用分层存储时创建段文件失败抛出 std::runtime_error
+    explicit Store(const std::string& aof_file, size_t compress_threshold = 0,
+                   TieredOptions tiered = {});
     ~Store();
 
-    void set(const std::string& key, const std::string& value);
-    std::string get(const std::string& key) const;
+    void set(const std::string& key, std::string_view value);
+    // 保存已压缩的 value（AOF 中的 SETLZ 记录），数据损坏时返回 false
+    bool setCompressed(const std::string& key, size_t raw_size, std::string_view data);
+    // key 不存在、已过期或读取 ValueLog 失败时返回空字符串
+    std::string get(const std::string& key);
+    // getValue 的结果：找到 / key 不存在或已过期 / 已换出的 value 读取 ValueLog 失败
+    enum class GetResult { Found, Missing, ReadError };
+    // 取出 value 的引用（只增加引用计数，不复制数据）；已换出的 value 从 ValueLog 载入内存，
+    // 读取失败时 value 保持换出状态
+    GetResult getValue(const std::string& key, Value& value);
 
     bool setExpire(const std::string& key, int seconds);
+    // 完整遍历一次过期表，删除所有已过期的键
     void cleanupExpiredKeys();
+    /**
+     * 定时任务调用的增量过期清理，从上次停下的游标继续遍历过期表
+     *
+     * 到达 deadline 或完成一轮遍历时返回，返回本次删除的键数。
+     */
+    size_t activeExpireCycle(std::chrono::steady_clock::time_point deadline);
 
-private:
+    // 删除 key，lazy 为 true 时较大的 value 交给后台线程释放；key 不存在或已过期返回 false
+    bool del(const std::string& key, bool lazy);
+    // 清空所有键，lazy 为 true 时整张表交给后台线程释放
+    void flushAll(bool lazy);
+
+    /**
+     * SCAN 的单次调用，返回下一个游标（0 表示遍历结束）
+     *
+     * 每次最多访问 count * 10 个 bucket，过期键与不匹配 pattern 的键被跳过；
+     * pattern 不含通配符时直接做一次精确查找。
+     */
+    uint64_t scan(uint64_t cursor, size_t count, std::string_view pattern,
+                  std::vector<std::string>& keys) const;
+    // KEYS：一次返回所有匹配的键，耗时与键总数成正比
+    std::vector<std::string> keys(std::string_view pattern) const;
+
+    // 增量遍历键空间 fn(key, const Value&)，供 SCAN 以及快照、迁移等内部流程使用，
+    // 两次调用之间可以正常处理其他请求
+    template <typename F>
+    uint64_t scanEntries(uint64_t cursor, size_t count, F&& fn) const {
+        auto now = std::chrono::system_clock::now();
+        size_t visited = 0;
+        size_t max_buckets = std::max<size_t>(count, 1) * 10;
+        do {
+            cursor = data_.scan(cursor, [&](const std::string& key, const Value& value) {
+                ++visited;
+                const time_point* when = expirations_.find(key);
+                if (when && now >= *when) {
+                    return;
+                }
+                fn(key, value);
+            });
+        } while (cursor != 0 && --max_buckets > 0 && visited < count);
+        return cursor;
+    }
+
+    // 惰性释放开关：过期清理、隐式删除（SET 覆盖旧值）、DEL 命令
+    bool lazyFreeExpire() const { return lazyfree_lazy_expire_; }
+    void setLazyFreeExpire(bool on) { lazyfree_lazy_expire_ = on; }
+    bool lazyFreeServerDel() const { return lazyfree_lazy_server_del_; }
+    void setLazyFreeServerDel(bool on) { lazyfree_lazy_server_del_ = on; }
+    bool lazyFreeUserDel() const { return lazyfree_lazy_user_del_; }
+    void setLazyFreeUserDel(bool on) { lazyfree_lazy_user_del_ = on; }
+    const LazyFree& lazyFree() const { return lazy_free_; }
+
+    // 0 表示不压缩；只影响之后写入的 value
+    size_t compressThreshold() const { return compress_threshold_; }
+    void setCompressThreshold(size_t threshold) { compress_threshold_ = threshold; }
+    uint64_t compressedValues() const { return compressed_values_; }
+    // 已压缩 value 的原始总长度与压缩后的总长度
+    uint64_t compressedRawBytes() const { return compressed_raw_bytes_; }
+    uint64_t compressedStoredBytes() const { return compressed_stored_bytes_; }
+
+    /**
+     * 分层存储：内存中 value 的总字节数超过 max_memory 时，按 CLOCK 算法把冷 value
+     * 写入 ValueLog 并释放内存，键、过期时间和 value 长度始终留在内存中
+     */
+    bool tiered() const { return log_ != nullptr; }
+    size_t tieredMaxMemory() const { return tiered_.max_memory; }
+    void setTieredMaxMemory(size_t bytes) { tiered_.max_memory = bytes; }
+    size_t tieredMinValueSize() const { return tiered_.min_value_size; }
+    void setTieredMinValueSize(size_t bytes) { tiered_.min_value_size = bytes; }
+    int tieredCompactGarbagePercent() const { return tiered_.compact_garbage_percent; }
+    void setTieredCompactGarbagePercent(int percent) { tiered_.compact_garbage_percent = percent; }
+    // 定时任务调用：换出冷 value 直到回到内存上限以下或到达 deadline
+    void evictColdValues(std::chrono::steady_clock::time_point deadline);
+    // 定时任务调用：把垃圾比例高的段中仍有效的记录搬到当前段，然后删除该段
+    void compactValueLog(std::chrono::steady_clock::time_point deadline);
+    // 已换出的 value 提示内核异步预读，流水线中后面的 GET 读盘时不必同步等待
+    void prefetch(std::string_view key) const;
+    // key 的 value 已换出且不全在 page cache 中时发起异步预读并返回 false，此时读取会阻塞；
+    // 其余情况（包括 key 不存在）返回 true
+    bool coldValueCached(std::string_view key) const;
+    bool hasSpilledValues() const { return spilled_values_ > 0; }
+
+    uint64_t residentValueBytes() const { return resident_value_bytes_; }
+    uint64_t spilledValues() const { return spilled_values_; }
+    uint64_t tieredEvictions() const { return tiered_evictions_; }
+    uint64_t tieredReads() const { return tiered_reads_; }
+    uint64_t tieredCompactedBytes() const { return tiered_compacted_bytes_; }
+    const ValueLog* valueLog() const { return log_.get(); }
+
+    size_t size() const { return data_.size(); }
+    size_t expiresSize() const { return expirations_.size(); }
+    uint64_t keyspaceHits() const { return keyspace_hits_; }
+    uint64_t keyspaceMisses() const { return keyspace_misses_; }
+    uint64_t expiredKeys() const { return expired_keys_; }
+
+    // 正在重放 AOF，只在此期间接受 SETLZ 等内部记录
+    bool loading() const { return loading_; }
+
+    const std::string& aofFile() const { return aof_file_; }
+    uint64_t aofSize() const { return aof_size_; }
+    bool aofLastWriteOk() const { return aof_last_write_ok_; }
+    AofFsync aofFsync() const { return aof_fsync_; }
+    void setAofFsync(AofFsync policy) { aof_fsync_ = policy; }
+
+    // 以 RESP 数组格式追加写入 AOF，always 策略下立即 fdatasync
     void logCommand(const std::vector<std::string_view>& command);
+    // 把已写入内核的 AOF 数据落盘，没有新数据时直接返回；everysec 策略下由定时任务调用
+    void fsyncAof();
+
+private:
     void replayAof();
+    bool isExpired(const std::string& key) const;
+    // 删除已过期的 key，惰性释放时节点放入 garbage
+    void expireKey(const std::string& key,
+                   std::vector<std::unique_ptr<Dict<Value>::Entry>>& garbage);
+    // 写入或移除 value 时更新压缩与分层存储的统计，移除时释放 ValueLog 中的记录
+    void addValueStats(const Value& value);
+    void removeValueStats(const std::string& key, const Value& value);
+    // 从 CLOCK 指针处继续扫描，最多访问 max_buckets 个 bucket 或到达 deadline
+    void evictValues(size_t max_buckets, std::chrono::steady_clock::time_point deadline);
+    // 写入日志（已写入时跳过）后释放内存中的数据，写入失败返回 false
+    bool spill(const std::string& key, Value& value);
 
-    std::unordered_map<std::string, std::string> data_;
-    std::unordered_map<std::string, time_point> expirations_;
+    // 小于该大小的 value 直接在事件循环中释放，移交后台线程反而更慢
+    static constexpr size_t LAZYFREE_THRESHOLD{64 * 1024};
+    // 写命令超出内存上限时同步换出，每次最多访问的 bucket 数；其余交给定时任务
+    static constexpr size_t EVICT_BUCKETS_PER_WRITE{16};
 
-    std::ofstream aof_;
+    Dict<Value> data_;
+    Dict<time_point> expirations_;
+    uint64_t expire_cursor_{0};  // activeExpireCycle 的遍历位置
+
+    int aof_fd_{-1};
     std::string aof_file_;
+    uint64_t aof_size_{0};
+    uint64_t aof_synced_size_{0};
+    bool aof_last_write_ok_{true};
+    bool loading_{false};
+    AofFsync aof_fsync_{AofFsync::EverySec};
+
+    uint64_t keyspace_hits_{0};
+    uint64_t keyspace_misses_{0};
+    uint64_t expired_keys_{0};
+
+    bool lazyfree_lazy_expire_{true};
+    bool lazyfree_lazy_server_del_{true};
+    bool lazyfree_lazy_user_del_{false};
+    LazyFree lazy_free_;
+
+    size_t compress_threshold_;
+    uint64_t compressed_values_{0};
+    uint64_t compressed_raw_bytes_{0};
+    uint64_t compressed_stored_bytes_{0};
+
+    TieredOptions tiered_;
+    std::unique_ptr<ValueLog> log_;
+    uint64_t resident_value_bytes_{0};
+    uint64_t spilled_values_{0};
+    uint64_t evict_cursor_{0};  // CLOCK 指针，即 data_ 的 scan 游标
+    uint32_t compact_segment_{0};  // 正在整理的段，0 表示没有
+    size_t compact_offset_{0};
+    uint64_t tiered_evictions_{0};
+    uint64_t tiered_reads_{0};
+    uint64_t tiered_compacted_bytes_{0};
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "client.hpp"
+
+/**
+ * 服务端辅助的客户端缓存：记录哪些连接读过哪些键，键被修改时推送失效消息
+ *
+ * - 默认模式：GET 时记录 key -> 客户端 id，失效消息发出后该记录即被删除
+ * - BCAST 模式：只按前缀登记客户端，任何匹配前缀的键变化都会通知，不占用键表
+ *
+ * 键表超过 max_keys 时逐出任意键，并向读过它的客户端发送失效消息，
+ * 因此客户端本地缓存始终是服务端状态的子集。
+ */
+class Tracking {
+public:
+    static Tracking& getInstance();
+
+    // 所有连接都需要登记，以便按 id 查找 REDIRECT 目标
+    void addClient(Client& client);
+    void removeClient(Client& client);
+    Client* findClient(uint64_t id) const;
+
+    // 开启/关闭某个客户端的跟踪，调用前已设置好 client 的 tracking_* 字段
+    void enable(Client& client);
+    void disable(Client& client);
+
+    // 客户端读取了 key（仅默认模式记录）
+    void trackRead(const Client& client, std::string_view key);
+    // key 被修改、删除或过期
+    void invalidate(std::string_view key);
+    // 整个键空间被清空
+    void invalidateAll();
+
+    // 正在执行命令的客户端，用于 NOLOOP；0 表示不是由客户端触发（如过期）
+    void setCurrentClient(uint64_t id) { current_client_ = id; }
+
+    // 向客户端写入推送数据后的回调，Server 借此注册 EPOLLOUT
+    void setOutputHandler(std::function<void(Client&)> handler) {
+        on_output_ = std::move(handler);
+    }
+
+    size_t trackingClients() const { return tracking_clients_; }
+    size_t totalKeys() const { return keys_.size(); }
+    size_t totalPrefixes() const { return prefixes_.size(); }
+    size_t maxKeys() const { return max_keys_; }
+    void setMaxKeys(size_t max_keys);
+
+private:
+    Tracking() = default;
+
+    static constexpr size_t DEFAULT_MAX_KEYS{1000000};
+
+    // 支持以 std::string_view 直接查找，写路径上不构造临时字符串
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    void sendInvalidation(uint64_t client_id, const std::string* key);
+    void evictKeys();
+
+    std::unordered_map<uint64_t, Client*> clients_;
+    std::unordered_map<std::string, std::unordered_set<uint64_t>, StringHash, std::equal_to<>>
+        keys_;
+    std::map<std::string, std::unordered_set<uint64_t>, std::less<>> prefixes_;
+    size_t tracking_clients_{0};
+    size_t max_keys_{DEFAULT_MAX_KEYS};
+    uint64_t current_client_{0};
+    std::function<void(Client&)> on_output_;
+};
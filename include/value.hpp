@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "shared_buffer.hpp"
+
+/**
+ * Store 中保存的字符串 value，创建后不再修改
+ *
+ * 数据保存在带引用计数的 SharedBuffer 中，复制 Value 只增加引用计数，GET 可以直接引用它发送。
+ * 超过阈值的 value 尝试用内置的 LZ 编码压缩，压缩后至少节省 1/8 才以压缩形式保存，
+ * 否则原样保存；读取时按需解压。压缩形式的 value 总是比原始数据短，
+ * 因此 size() 与存储长度不同即表示已压缩，不需要额外的标志位。
+ *
+ * 启用分层存储时，冷 value 的数据可以换出到 ValueLog，只在内存中保留长度和日志中的位置：
+ * 写入日志后数据仍可留在内存中（干净），之后换出只需丢弃缓冲区；换出后读取时由 Store 载入。
+ */
+class Value {
+public:
+    Value() = default;
+    explicit Value(std::string_view raw)
+        : data_(SharedBuffer::copyOf(raw)), size_(raw.size()), stored_size_(raw.size()) {}
+
+    // compress_threshold 为 0 或 raw 小于该值时不压缩
+    static Value make(std::string_view raw, size_t compress_threshold);
+    // 接管已压缩的数据（AOF 重放），数据损坏或不满足压缩形式的要求时返回 false
+    static bool fromCompressed(std::string_view data, size_t raw_size, Value& value);
+
+    bool compressed() const { return size_ != stored_size_; }
+    // 原始（解压后）长度
+    size_t size() const { return size_; }
+    // 存储的字节数，换出后也不变
+    size_t storedSize() const { return stored_size_; }
+    // 存储的字节，已压缩时为压缩数据；只能在 resident() 时调用
+    std::string_view data() const { return data_.view(); }
+
+    // 分层存储：数据是否在内存中
+    bool resident() const { return data_.size() == stored_size_; }
+    // 在 ValueLog 中的位置，NO_LOCATION 表示还没有写入日志
+    uint64_t location() const { return location_; }
+    void setLocation(uint64_t location) { location_ = location; }
+    // 丢弃内存中的数据，调用前必须已写入日志
+    void evict() { data_ = SharedBuffer(); }
+    // 载入从日志读回的存储字节
+    void load(SharedBuffer data) { data_ = std::move(data); }
+    // CLOCK 淘汰的访问位：访问时置位，淘汰扫描时清除，扫描到未置位的 value 才换出
+    bool referenced() const { return referenced_; }
+    void touch() { referenced_ = true; }
+    void clearReferenced() { referenced_ = false; }
+
+    static constexpr uint64_t NO_LOCATION{UINT64_MAX};
+
+    // 原始数据：未压缩时与 Store 共享同一块内存，已压缩时解压到新的缓冲区
+    SharedBuffer raw() const;
+    std::string str() const;
+
+private:
+    SharedBuffer data_;
+    size_t size_{0};
+    size_t stored_size_{0};
+    uint64_t location_{NO_LOCATION};
+    bool referenced_{true};
+};
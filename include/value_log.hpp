@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+
+/**
+ * 分层存储的值日志：冷 value 追加写入按段切分的文件，读取时通过 mmap 走 page cache
+ *
+ * 每个段是一个 SEGMENT_SIZE 大小的稀疏文件，整段以只读方式 mmap；写入用 pwritev 追加到
+ * 当前段末尾，写满后切换到新段。记录格式为 [key 长度 u32][value 长度 u32][key][value]，
+ * 位置编码为 (段号 << 32) | value 在段内的偏移。
+ * 只有当前段保留 fd：写满的段关闭 fd 后映射仍然有效，日志始终只占用一个 fd，
+ * 不挤占按 maxclients 计算的 fd 配额；映射只占虚拟地址空间，页面由 page cache 管理。
+ * 覆盖或删除后记录成为垃圾，Store 的整理任务把垃圾比例高的段中仍有效的记录搬到当前段，
+ * 然后删除整个段文件。
+ * 日志只是内存的延伸而不是持久化：数据以 AOF 为准，启动时删除残留的段文件。
+ */
+class ValueLog {
+public:
+    static constexpr size_t SEGMENT_SIZE{64 * 1024 * 1024};
+    static constexpr size_t HEADER_SIZE{8};
+
+    // 段文件为 path.<段号>，失败时抛出 std::runtime_error
+    explicit ValueLog(std::string path);
+    ~ValueLog();
+
+    ValueLog(const ValueLog&) = delete;
+    ValueLog& operator=(const ValueLog&) = delete;
+
+    // 追加一条记录，写入失败或记录超过段大小时返回 false
+    bool append(std::string_view key, std::string_view value, uint64_t& location);
+    // 指向 mmap 区域的视图，访问时可能因缺页而同步读盘；位置不在已写入的范围内时返回 false
+    bool read(uint64_t location, size_t size, std::string_view& data) const;
+    // value 所在的页是否都已在 page cache 中（mincore），是则读取时不会同步读盘
+    bool cached(uint64_t location, size_t size) const;
+    // 提示内核异步预读 value 所在的页，不阻塞
+    void prefetch(uint64_t location, size_t size) const;
+    // 记录被覆盖或删除，计入所在段的垃圾
+    void release(uint64_t location, size_t key_size, size_t value_size);
+    // 删除全部段（FLUSHALL）
+    void clear();
+
+    // 选出垃圾比例不低于 min_garbage_percent 的已写满段中垃圾最多的一个
+    bool pickSegment(int min_garbage_percent, uint32_t& segment) const;
+    // 读取段内 offset 处的记录，没有更多记录时返回 false；next 为下一条记录的偏移
+    bool recordAt(uint32_t segment, size_t offset, std::string_view& key,
+                  std::string_view& value, uint64_t& location, size_t& next) const;
+    size_t segmentLiveBytes(uint32_t segment) const;
+    void removeSegment(uint32_t segment);
+
+    size_t segments() const { return segments_.size(); }
+    // 段文件中已写入的字节数与其中仍被引用的字节数
+    uint64_t diskBytes() const { return disk_bytes_; }
+    uint64_t liveBytes() const { return live_bytes_; }
+
+    static size_t recordSize(size_t key_size, size_t value_size) {
+        return HEADER_SIZE + key_size + value_size;
+    }
+
+private:
+    struct Segment {
+        int fd{-1};  // 只有当前段打开，其余为 -1
+        char* map{nullptr};
+        size_t size{0};  // 已写入的字节数
+        size_t live{0};  // 仍被引用的记录字节数
+    };
+
+    Segment& openSegment(uint32_t id);
+    void closeSegment(uint32_t id, Segment& segment);
+    std::string segmentPath(uint32_t id) const;
+
+    std::string path_;
+    std::map<uint32_t, Segment> segments_;
+    uint32_t active_{0};  // 当前追加写入的段，0 表示还没有
+    uint32_t next_id_{1};
+    uint64_t disk_bytes_{0};
+    uint64_t live_bytes_{0};
+};
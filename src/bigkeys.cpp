@@ -0,0 +1,62 @@
+#include "bigkeys.hpp"
+
+#include <algorithm>
+#include <functional>
+
+BigKeys& BigKeys::getInstance() {
+    static BigKeys instance;
+    return instance;
+}
+
+void BigKeys::start(size_t top) {
+    state_ = State::Running;
+    cursor_ = 0;
+    top_ = std::clamp<size_t>(top, 1, MAX_TOP);
+    scanned_keys_ = 0;
+    total_bytes_ = 0;
+    heap_.clear();
+}
+
+void BigKeys::stop() {
+    if (state_ == State::Running) {
+        state_ = State::Idle;
+    }
+}
+
+void BigKeys::step(const Store& store, std::chrono::steady_clock::time_point deadline) {
+    while (state_ == State::Running && std::chrono::steady_clock::now() < deadline) {
+        scanBatch(store);
+    }
+}
+
+void BigKeys::scanBatch(const Store& store) {
+    // std::greater 使 make_heap 得到最小堆，堆顶是当前结果中最小的 value
+    auto cmp = std::greater<>{};
+    cursor_ = store.scanEntries(cursor_, STEP_KEYS,
+                                [&](const std::string& key, const Value& value) {
+                                    ++scanned_keys_;
+                                    total_bytes_ += value.size();
+                                    if (heap_.size() < top_) {
+                                        heap_.emplace_back(value.size(), key);
+                                        std::push_heap(heap_.begin(), heap_.end(), cmp);
+                                    } else if (value.size() > heap_.front().first) {
+                                        std::pop_heap(heap_.begin(), heap_.end(), cmp);
+                                        heap_.back() = {value.size(), key};
+                                        std::push_heap(heap_.begin(), heap_.end(), cmp);
+                                    }
+                                });
+    if (cursor_ == 0) {
+        state_ = State::Done;
+    }
+}
+
+std::vector<std::pair<std::string, size_t>> BigKeys::biggest() const {
+    auto sorted = heap_;
+    std::sort(sorted.begin(), sorted.end(), std::greater<>{});
+    std::vector<std::pair<std::string, size_t>> result;
+    result.reserve(sorted.size());
+    for (auto& [size, key] : sorted) {
+        result.emplace_back(std::move(key), size);
+    }
+    return result;
+}
@@ -1,70 +1,165 @@
 #include "command.hpp"
 
+#include <malloc.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <iomanip>
+#include <map>
 #include <sstream>
 
+#include "bigkeys.hpp"
+#include "config.hpp"
+#include "hotkeys.hpp"
+#include "stats.hpp"
+#include "tracking.hpp"
+
 /*
 void Command::registerCommand(std::string_view name, Handler handler) { handlers_[name] = handler; }
 */
 
-bool Command::parseResp(std::string_view buffer, size_t& consumed,
-                        std::vector<std::string_view>& result) {
+namespace {
+    // 解析 CRLF 之前的十进制长度，含非数字字符或溢出时返回 false
+    bool parseLength(std::string_view digits, int& out) {
+        if (digits.empty()) {
+            return false;
+        }
+        auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), out);
+        return ec == std::errc() && ptr == digits.data() + digits.size();
+    }
+
+    // 等待冷 value 读入 page cache 的上限
+    constexpr std::chrono::milliseconds COLD_READ_TIMEOUT{1000};
+
+    // 命令要读的冷 value 是否都已在 page cache 中；EXEC 检查事务中所有的 GET，一起预读
+    bool coldValuesCached(const std::vector<std::string_view>& tokens, const Store& store,
+                          const Client& client) {
+        if (tokens[0] == "GET" && tokens.size() == 2) {
+            return store.coldValueCached(tokens[1]);
+        }
+        bool cached = true;
+        if (tokens[0] == "EXEC" && client.in_transaction) {
+            for (const auto& cmd : client.transaction_queue) {
+                if (cmd.size() == 2 && cmd[0] == "GET" && !store.coldValueCached(cmd[1])) {
+                    cached = false;
+                }
+            }
+        }
+        return cached;
+    }
+}
+
+Command::ParseResult Command::parseResp(std::string_view buffer, size_t& consumed,
+                                        std::vector<std::string_view>& result) {
+    // 与 Redis 一致的上限，超出视为协议错误而不是等待更多数据
+    static constexpr int MAX_MULTIBULK_LEN{1024 * 1024};
+
     consumed = 0;
-    if (buffer.empty() || buffer[0] != '*') {
-        return false;
+    if (buffer.empty()) {
+        return ParseResult::Incomplete;
+    }
+    if (buffer[0] != '*') {
+        return ParseResult::Error;
     }
 
     size_t pos = buffer.find("\r\n");
     if (pos == std::string_view::npos) {
-        return false;
+        return ParseResult::Incomplete;
     }
-    std::string_view len_str = buffer.substr(1, pos - 1);
     int len;
-    try {
-        len = std::stoi(std::string(len_str));
-    } catch (...) {
-        return false;
-    }
-    if (len < 0) {
-        return false;
+    if (!parseLength(buffer.substr(1, pos - 1), len) || len < 0 || len > MAX_MULTIBULK_LEN) {
+        return ParseResult::Error;
     }
-    consumed = pos + 2;
+    size_t offset = pos + 2;
 
     result.clear();
     for (int i = 0; i < len; ++i) {
-        if (consumed >= buffer.size() || buffer[consumed] != '$') {
-            return false;
+        if (offset >= buffer.size()) {
+            return ParseResult::Incomplete;
+        }
+        if (buffer[offset] != '$') {
+            return ParseResult::Error;
         }
-        pos = buffer.find("\r\n", consumed);
+        pos = buffer.find("\r\n", offset);
         if (pos == std::string_view::npos) {
-            return false;
+            return ParseResult::Incomplete;
         }
-        std::string_view str_len = buffer.substr(consumed + 1, pos - consumed - 1);
         int str_size;
-        try {
-            str_size = std::stoi(std::string(str_len));
-        } catch (...) {
-            return false;
+        if (!parseLength(buffer.substr(offset + 1, pos - offset - 1), str_size) || str_size < 0) {
+            return ParseResult::Error;
         }
-        consumed = pos + 2;
-        if (str_size < 0 || consumed + str_size + 2 > buffer.size()) {
-            return false;
+        offset = pos + 2;
+        if (offset + str_size + 2 > buffer.size()) {
+            return ParseResult::Incomplete;
+        }
+        if (buffer[offset + str_size] != '\r' || buffer[offset + str_size + 1] != '\n') {
+            return ParseResult::Error;
         }
-        result.push_back(buffer.substr(consumed, str_size));
-        consumed += str_size + 2;
+        result.push_back(buffer.substr(offset, str_size));
+        offset += str_size + 2;
     }
-    return true;
+    consumed = offset;
+    return ParseResult::Ok;
 }
 
 std::string Command::process(std::string_view buffer, size_t& consumed, Store& store,
                              Client& client) {
     std::vector<std::string_view> tokens;
-    if (!parseResp(buffer, consumed, tokens)) {
-        return "-ERR invalid RESP protocol\r\n";
+    ParseResult parsed = parseResp(buffer, consumed, tokens);
+    if (parsed == ParseResult::Incomplete) {
+        return "";  // 数据不完整时不消耗任何字节，等待后续数据到达
+    }
+    if (parsed == ParseResult::Error) {
+        // 出错位置之后的数据无法再对齐到命令边界，回复错误后关闭连接
+        client.close_after_reply = true;
+        return "-ERR Protocol error: invalid RESP request\r\n";
     }
     if (tokens.empty()) {
         return "-ERR empty command\r\n";
     }
 
+    // 事务中排队的命令在 EXEC 时才统计
+    bool queued = client.in_transaction && tokens[0] != "EXEC" && tokens[0] != "DISCARD";
+    if (!queued && store.hasSpilledValues() && !store.loading()) {
+        // 要读的冷 value 不在 page cache 中时不执行，等预读完成后由 Server 重新执行，
+        // 事件循环不会因缺页同步读盘而阻塞
+        if (!coldValuesCached(tokens, store, client)) {
+            auto now = std::chrono::steady_clock::now();
+            if (!client.waiting_for_disk) {
+                client.waiting_for_disk = true;
+                client.disk_wait_since = now;
+            }
+            if (now - client.disk_wait_since < COLD_READ_TIMEOUT) {
+                consumed = 0;
+                return "";
+            }
+            // 长时间读不进来多半是磁盘出错，此时访问映射区会收到 SIGBUS，只能放弃这条命令
+            client.waiting_for_disk = false;
+            if (tokens[0] == "EXEC") {
+                client.in_transaction = false;
+                client.transaction_queue.clear();
+            }
+            return "-ERR timed out reading value from tiered storage\r\n";
+        }
+        client.waiting_for_disk = false;
+    }
+    auto& tracking = Tracking::getInstance();
+    tracking.setCurrentClient(client.id);
+    auto start = Stats::Clock::now();
+    std::string response = dispatch(tokens, store, client);
+    tracking.setCurrentClient(0);
+    if (!queued) {
+        auto elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(Stats::Clock::now() - start);
+        Stats::getInstance().recordCommand(tokens, static_cast<uint64_t>(elapsed.count()));
+    }
+    return response;
+}
+
+std::string Command::dispatch(const std::vector<std::string_view>& tokens, Store& store,
+                              Client& client) {
     if (tokens[0] == "MULTI") {
         if (client.in_transaction) {
             return "-ERR MULTI calls can not be nested\r\n";
@@ -82,16 +177,18 @@ std::string Command::process(std::string_view buffer, size_t& consumed, Store& s
         if (client.transaction_queue.empty()) {
             return "*0\r\n";
         }
-        std::string response = "*" + std::to_string(client.transaction_queue.size()) + "\r\n";
+        // 逐条写入 client.response 而不是拼成一个字符串，GET 等命令可以直接排队 value 的引用
+        auto& response = client.response;
+        response.append("*" + std::to_string(client.transaction_queue.size()) + "\r\n");
         for (const auto& cmd : client.transaction_queue) {
             // auto it = handlers_.find(cmd[0]);
             auto command = CommandFactory::getInstance().createCommand(cmd[0]);
             if (!command /* it == handlers_.end()*/) {
-                response += "-ERR unknown command '" + cmd[0] + "'\r\n";
+                response.append("-ERR unknown command '" + cmd[0] + "'\r\n");
                 continue;
             }
             if (cmd[0] == "MULTI" || cmd[0] == "EXEC" || cmd[0] == "DISCARD") {
-                response += "-ERR command '" + cmd[0] + "' not allowed in transaction\r\n";
+                response.append("-ERR command '" + cmd[0] + "' not allowed in transaction\r\n");
                 continue;
             }
             std::vector<std::string_view> cmd_view;
@@ -100,10 +197,14 @@ std::string Command::process(std::string_view buffer, size_t& consumed, Store& s
                 cmd_view.push_back(s);
             }
             // response += it->second(cmd_view, store, client);
-            response += command->execute(cmd_view, store, client);
+            auto start = Stats::Clock::now();
+            response.append(command->execute(cmd_view, store, client));
+            auto elapsed =
+                std::chrono::duration_cast<std::chrono::microseconds>(Stats::Clock::now() - start);
+            Stats::getInstance().recordCommand(cmd_view, static_cast<uint64_t>(elapsed.count()));
         }
         client.transaction_queue.clear();
-        return response;
+        return "";
     }
 
     if (tokens[0] == "DISCARD") {
@@ -193,23 +294,65 @@ namespace {
             if (tokens.size() != 3) {
                 return "-ERR wrong number of arguments for 'SET' command\r\n";
             }
-            store.set(std::string(tokens[1]), std::string(tokens[2]));
+            HotKeys::getInstance().touch(tokens[1]);
+            store.set(std::string(tokens[1]), tokens[2]);
             return "+OK\r\n";
         }
     };
 
-    class GetCommand : public Command {
+    // SETLZ key raw-length payload：AOF 中已压缩 value 的记录，payload 为内置 LZ 编码的数据；
+    // 只在重放 AOF 时可用，对客户端表现为不存在的命令
+    class SetlzCommand : public Command {
     public:
         std::string execute(const std::vector<std::string_view>& tokens, Store& store,
                             Client&) override {
+            if (!store.loading()) {
+                return "-ERR unknown command 'SETLZ'\r\n";
+            }
+            if (tokens.size() != 4) {
+                return "-ERR wrong number of arguments for 'SETLZ' command\r\n";
+            }
+            size_t raw_size;
+            try {
+                size_t pos = 0;
+                raw_size = std::stoull(std::string(tokens[2]), &pos);
+                if (pos != tokens[2].size()) {
+                    throw std::invalid_argument("trailing characters");
+                }
+            } catch (...) {
+                return "-ERR value is not an integer or out of range\r\n";
+            }
+            if (!store.setCompressed(std::string(tokens[1]), raw_size, tokens[3])) {
+                return "-ERR invalid compressed payload\r\n";
+            }
+            return "+OK\r\n";
+        }
+    };
+
+    class GetCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store& store,
+                            Client& client) override {
             if (tokens.size() != 2) {
                 return "-ERR wrong number of arguments for 'GET' command\r\n";
             }
-            std::string value = store.get(std::string(tokens[1]));
-            if (value.empty()) {
+            HotKeys::getInstance().touch(tokens[1]);
+            if (client.tracking) {
+                Tracking::getInstance().trackRead(client, tokens[1]);
+            }
+            Value value;
+            Store::GetResult result = store.getValue(std::string(tokens[1]), value);
+            if (result == Store::GetResult::ReadError) {
+                return "-ERR failed to read value from tiered storage\r\n";
+            }
+            if (result == Store::GetResult::Missing || value.size() == 0) {
                 return "$-1\r\n";
             }
-            return "$" + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+            // 之前的响应都已写入 client.response，这里直接排队：协议头拷贝，value 只引用
+            client.response.append("$" + std::to_string(value.size()) + "\r\n");
+            client.response.append(value.raw());
+            client.response.append("\r\n");
+            return "";
         }
     };
 
@@ -226,6 +369,7 @@ namespace {
             } catch (...) {
                 return "-ERR value is not an integer or out of range\r\n";
             }
+            HotKeys::getInstance().touch(tokens[1]);
             bool success = store.setExpire(std::string(tokens[1]), seconds);
             return success ? ":1\r\n" : ":0\r\n";
         }
@@ -261,15 +405,663 @@ namespace {
         }
     };
 
+    std::string bulkString(std::string_view value) {
+        return "$" + std::to_string(value.size()) + "\r\n" + std::string(value) + "\r\n";
+    }
+
+    std::string integerReply(int64_t value) { return ":" + std::to_string(value) + "\r\n"; }
+
+    std::string toUpper(std::string_view value) {
+        std::string result(value);
+        for (auto& ch : result) {
+            ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+        }
+        return result;
+    }
+
+    std::string toLower(std::string_view value) {
+        std::string result(value);
+        for (auto& ch : result) {
+            ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        }
+        return result;
+    }
+
+    std::string bytesToHuman(uint64_t bytes) {
+        static constexpr const char* units[] = {"B", "K", "M", "G", "T"};
+        double value = static_cast<double>(bytes);
+        size_t unit = 0;
+        while (value >= 1024 && unit + 1 < std::size(units)) {
+            value /= 1024;
+            ++unit;
+        }
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(unit == 0 ? 0 : 2);
+        out << value << units[unit];
+        return out.str();
+    }
+
+    uint64_t residentMemory() {
+        std::ifstream statm("/proc/self/statm");
+        uint64_t pages = 0, resident = 0;
+        if (!(statm >> pages >> resident)) {
+            return 0;
+        }
+        return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    class DelCommand : public Command {
+    public:
+        explicit DelCommand(bool unlink) : unlink_(unlink) {}
+
+        std::string execute(const std::vector<std::string_view>& tokens, Store& store,
+                            Client&) override {
+            if (tokens.size() < 2) {
+                return "-ERR wrong number of arguments for '" + std::string(tokens[0]) +
+                       "' command\r\n";
+            }
+            bool lazy = unlink_ || store.lazyFreeUserDel();
+            int64_t removed = 0;
+            for (size_t i = 1; i < tokens.size(); ++i) {
+                HotKeys::getInstance().touch(tokens[i]);
+                if (store.del(std::string(tokens[i]), lazy)) {
+                    ++removed;
+                }
+            }
+            return integerReply(removed);
+        }
+
+    private:
+        bool unlink_;
+    };
+
+    class FlushCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store& store,
+                            Client&) override {
+            if (tokens.size() > 2) {
+                return "-ERR wrong number of arguments for '" + std::string(tokens[0]) +
+                       "' command\r\n";
+            }
+            bool lazy = false;
+            if (tokens.size() == 2) {
+                std::string mode = toUpper(tokens[1]);
+                if (mode == "ASYNC") {
+                    lazy = true;
+                } else if (mode != "SYNC") {
+                    return "-ERR syntax error\r\n";
+                }
+            }
+            store.flushAll(lazy);
+            return "+OK\r\n";
+        }
+    };
+
+    class ScanCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store& store,
+                            Client&) override {
+            if (tokens.size() < 2 || tokens.size() % 2 != 0) {
+                return "-ERR wrong number of arguments for 'SCAN' command\r\n";
+            }
+            uint64_t cursor;
+            try {
+                size_t pos = 0;
+                cursor = std::stoull(std::string(tokens[1]), &pos);
+                if (pos != tokens[1].size() || tokens[1][0] == '-') {
+                    throw std::invalid_argument("cursor");
+                }
+            } catch (...) {
+                return "-ERR invalid cursor\r\n";
+            }
+
+            std::string_view pattern = "*";
+            std::string type;
+            size_t count = 10;
+            for (size_t i = 2; i < tokens.size(); i += 2) {
+                std::string opt = toUpper(tokens[i]);
+                if (opt == "MATCH") {
+                    pattern = tokens[i + 1];
+                } else if (opt == "COUNT") {
+                    try {
+                        int n = std::stoi(std::string(tokens[i + 1]));
+                        if (n < 1) {
+                            return "-ERR syntax error\r\n";
+                        }
+                        count = static_cast<size_t>(n);
+                    } catch (...) {
+                        return "-ERR value is not an integer or out of range\r\n";
+                    }
+                } else if (opt == "TYPE") {
+                    type = toLower(tokens[i + 1]);
+                } else {
+                    return "-ERR syntax error\r\n";
+                }
+            }
+
+            std::vector<std::string> keys;
+            cursor = store.scan(cursor, count, pattern, keys);
+            // 目前所有值都是 string 类型，其他 TYPE 过滤掉全部键，但游标照常推进
+            if (!type.empty() && type != "string") {
+                keys.clear();
+            }
+
+            std::string response = "*2\r\n" + bulkString(std::to_string(cursor));
+            response += "*" + std::to_string(keys.size()) + "\r\n";
+            for (const auto& key : keys) {
+                response += bulkString(key);
+            }
+            return response;
+        }
+    };
+
+    class KeysCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store& store,
+                            Client&) override {
+            if (tokens.size() != 2) {
+                return "-ERR wrong number of arguments for 'KEYS' command\r\n";
+            }
+            auto keys = store.keys(tokens[1]);
+            std::string response = "*" + std::to_string(keys.size()) + "\r\n";
+            for (const auto& key : keys) {
+                response += bulkString(key);
+            }
+            return response;
+        }
+    };
+
+    class ClientCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store&,
+                            Client& client) override {
+            if (tokens.size() < 2) {
+                return "-ERR wrong number of arguments for 'CLIENT' command\r\n";
+            }
+            std::string sub = toUpper(tokens[1]);
+            if (sub == "ID" && tokens.size() == 2) {
+                return integerReply(static_cast<int64_t>(client.id));
+            }
+            if (sub == "TRACKING" && tokens.size() >= 3) {
+                return tracking(tokens, client);
+            }
+            return "-ERR unknown subcommand or wrong number of arguments for 'CLIENT " +
+                   std::string(tokens[1]) + "'\r\n";
+        }
+
+    private:
+        // CLIENT TRACKING ON|OFF [REDIRECT id] [PREFIX prefix ...] [BCAST] [NOLOOP]
+        std::string tracking(const std::vector<std::string_view>& tokens, Client& client) {
+            auto& tracking = Tracking::getInstance();
+            std::string mode = toUpper(tokens[2]);
+            if (mode == "OFF" && tokens.size() == 3) {
+                tracking.disable(client);
+                return "+OK\r\n";
+            }
+            if (mode != "ON") {
+                return "-ERR syntax error\r\n";
+            }
+
+            bool bcast = false, noloop = false;
+            uint64_t redirect = 0;
+            std::vector<std::string> prefixes;
+            for (size_t i = 3; i < tokens.size(); ++i) {
+                std::string opt = toUpper(tokens[i]);
+                if (opt == "BCAST") {
+                    bcast = true;
+                } else if (opt == "NOLOOP") {
+                    noloop = true;
+                } else if (opt == "PREFIX" && i + 1 < tokens.size()) {
+                    prefixes.emplace_back(tokens[++i]);
+                } else if (opt == "REDIRECT" && i + 1 < tokens.size()) {
+                    try {
+                        redirect = std::stoull(std::string(tokens[++i]));
+                    } catch (...) {
+                        return "-ERR value is not an integer or out of range\r\n";
+                    }
+                } else {
+                    return "-ERR syntax error\r\n";
+                }
+            }
+            if (!prefixes.empty() && !bcast) {
+                return "-ERR PREFIX option requires BCAST mode to be enabled\r\n";
+            }
+            // 没有 Pub/Sub，失效消息只能以 RESP3 推送类型发送，RESP2 连接无法区分它与普通回复
+            if (redirect != 0) {
+                const Client* target = tracking.findClient(redirect);
+                if (target == nullptr) {
+                    return "-ERR The client ID you want redirect to does not exist\r\n";
+                }
+                if (target->resp < 3) {
+                    return "-ERR the client ID you want redirect to must use RESP3 (HELLO 3)\r\n";
+                }
+            } else if (client.resp < 3) {
+                return "-ERR tracking requires RESP3 (HELLO 3) or REDIRECT to a RESP3 client\r\n";
+            }
+
+            // 重新开启时先清掉旧的前缀登记
+            tracking.disable(client);
+            client.tracking_bcast = bcast;
+            client.tracking_noloop = noloop;
+            client.tracking_redirect = redirect;
+            client.tracking_prefixes = std::move(prefixes);
+            tracking.enable(client);
+            return "+OK\r\n";
+        }
+    };
+
+    class HelloCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store&,
+                            Client& client) override {
+            if (tokens.size() > 2) {
+                return "-ERR wrong number of arguments for 'HELLO' command\r\n";
+            }
+            if (tokens.size() == 2) {
+                if (tokens[1] == "2") {
+                    client.resp = 2;
+                } else if (tokens[1] == "3") {
+                    client.resp = 3;
+                } else {
+                    return "-NOPROTO unsupported protocol version\r\n";
+                }
+            }
+            std::string response = client.resp >= 3 ? "%3\r\n" : "*6\r\n";
+            response += bulkString("server") + bulkString("mini-redis");
+            response += bulkString("proto") + integerReply(client.resp);
+            response += bulkString("id") + integerReply(static_cast<int64_t>(client.id));
+            return response;
+        }
+    };
+
+    class InfoCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store& store,
+                            Client&) override {
+            if (tokens.size() > 2) {
+                return "-ERR wrong number of arguments for 'INFO' command\r\n";
+            }
+            std::string section = tokens.size() == 2 ? toLower(tokens[1]) : "default";
+            bool all = section == "all" || section == "everything";
+            bool def = all || section == "default";
+            auto wants = [&](std::string_view name) { return def || section == name; };
+
+            const auto& stats = Stats::getInstance();
+            std::ostringstream info;
+            if (wants("server")) {
+                info << "# Server\r\n"
+                     << "process_id:" << getpid() << "\r\n"
+                     << "tcp_port:" << stats.port() << "\r\n"
+                     << "hz:" << Config::getInstance().options().hz << "\r\n"
+                     << "uptime_in_seconds:" << stats.uptimeSeconds() << "\r\n"
+                     << "uptime_in_days:" << stats.uptimeSeconds() / 86400 << "\r\n\r\n";
+            }
+            if (wants("clients")) {
+                info << "# Clients\r\n"
+                     << "connected_clients:" << stats.connectedClients() << "\r\n"
+                     << "tracking_clients:" << Tracking::getInstance().trackingClients()
+                     << "\r\n\r\n";
+            }
+            if (wants("memory")) {
+                struct mallinfo2 mi = mallinfo2();
+                uint64_t used = mi.uordblks + mi.hblkhd;
+                uint64_t rss = residentMemory();
+                info << "# Memory\r\n"
+                     << "used_memory:" << used << "\r\n"
+                     << "used_memory_human:" << bytesToHuman(used) << "\r\n"
+                     << "used_memory_rss:" << rss << "\r\n"
+                     << "used_memory_rss_human:" << bytesToHuman(rss) << "\r\n"
+                     << "lazyfree_pending_objects:" << store.lazyFree().pendingObjects() << "\r\n"
+                     << "compressed_values:" << store.compressedValues() << "\r\n"
+                     << "compressed_values_raw_bytes:" << store.compressedRawBytes() << "\r\n"
+                     << "compressed_values_bytes:" << store.compressedStoredBytes() << "\r\n"
+                     << "compression_ratio:" << std::fixed << std::setprecision(2)
+                     << (store.compressedStoredBytes() == 0
+                             ? 1.0
+                             : static_cast<double>(store.compressedRawBytes()) /
+                                   static_cast<double>(store.compressedStoredBytes()))
+                     << "\r\n\r\n";
+            }
+            if (wants("persistence")) {
+                info << "# Persistence\r\n"
+                     << "aof_enabled:1\r\n"
+                     << "aof_filename:" << store.aofFile() << "\r\n"
+                     << "aof_current_size:" << store.aofSize() << "\r\n"
+                     << "aof_fsync:" << Config::getInstance().options().appendfsync << "\r\n"
+                     << "aof_last_write_status:" << (store.aofLastWriteOk() ? "ok" : "err")
+                     << "\r\n\r\n";
+            }
+            if (wants("tiered")) {
+                const ValueLog* log = store.valueLog();
+                info << "# Tiered\r\n"
+                     << "tiered_enabled:" << (store.tiered() ? 1 : 0) << "\r\n"
+                     << "tiered_max_memory:" << store.tieredMaxMemory() << "\r\n"
+                     << "tiered_resident_value_bytes:" << store.residentValueBytes() << "\r\n"
+                     << "tiered_spilled_values:" << store.spilledValues() << "\r\n"
+                     << "tiered_log_segments:" << (log ? log->segments() : 0) << "\r\n"
+                     << "tiered_log_bytes:" << (log ? log->diskBytes() : 0) << "\r\n"
+                     << "tiered_log_live_bytes:" << (log ? log->liveBytes() : 0) << "\r\n"
+                     << "tiered_evictions:" << store.tieredEvictions() << "\r\n"
+                     << "tiered_cold_reads:" << store.tieredReads() << "\r\n"
+                     << "tiered_compacted_bytes:" << store.tieredCompactedBytes()
+                     << "\r\n\r\n";
+            }
+            if (wants("stats")) {
+                info << "# Stats\r\n"
+                     << "total_connections_received:" << stats.totalConnections() << "\r\n"
+                     << "total_commands_processed:" << stats.totalCommands() << "\r\n"
+                     << "rejected_connections:" << stats.rejectedConnections() << "\r\n"
+                     << "total_net_input_bytes:" << stats.netInputBytes() << "\r\n"
+                     << "total_net_output_bytes:" << stats.netOutputBytes() << "\r\n"
+                     << "instantaneous_ops_per_sec:" << stats.instantaneousOps() << "\r\n"
+                     << "instantaneous_input_kbps:" << std::fixed << std::setprecision(2)
+                     << stats.instantaneousInputKbps() << "\r\n"
+                     << "instantaneous_output_kbps:" << stats.instantaneousOutputKbps() << "\r\n"
+                     << "expired_keys:" << store.expiredKeys() << "\r\n"
+                     << "lazyfreed_objects:" << store.lazyFree().freedObjects() << "\r\n"
+                     << "tracking_total_keys:" << Tracking::getInstance().totalKeys() << "\r\n"
+                     << "tracking_total_prefixes:" << Tracking::getInstance().totalPrefixes()
+                     << "\r\n"
+                     << "keyspace_hits:" << store.keyspaceHits() << "\r\n"
+                     << "keyspace_misses:" << store.keyspaceMisses() << "\r\n\r\n";
+            }
+            // 命令统计数量较多，只在显式指定或 all 时输出
+            if (all || section == "commandstats") {
+                info << "# Commandstats\r\n";
+                for (const auto& [name, stat] : stats.commandStats()) {
+                    info << "cmdstat_" << toLower(name) << ":calls=" << stat.calls
+                         << ",usec=" << stat.usec << ",usec_per_call=" << std::fixed
+                         << std::setprecision(2) << stat.latency.mean() << "\r\n";
+                }
+                info << "\r\n";
+            }
+            if (all || section == "cron") {
+                info << "# Cron\r\n";
+                for (const auto& [name, stat] : stats.cronStats()) {
+                    info << "cron_" << name << ":runs=" << stat.runs << ",usec=" << stat.usec
+                         << ",max_usec=" << stat.max_usec << ",over_budget=" << stat.over_budget
+                         << "\r\n";
+                }
+                info << "\r\n";
+            }
+            if (all || section == "latencystats") {
+                info << "# Latencystats\r\n";
+                for (const auto& [name, stat] : stats.commandStats()) {
+                    info << "latency_percentiles_usec_" << toLower(name)
+                         << ":p50=" << stat.latency.percentile(50)
+                         << ",p99=" << stat.latency.percentile(99)
+                         << ",p99.9=" << stat.latency.percentile(99.9)
+                         << ",max=" << stat.latency.max() << "\r\n";
+                }
+                info << "\r\n";
+            }
+            if (wants("keyspace")) {
+                info << "# Keyspace\r\n";
+                if (store.size() > 0) {
+                    info << "db0:keys=" << store.size() << ",expires=" << store.expiresSize()
+                         << "\r\n";
+                }
+            }
+            return bulkString(info.str());
+        }
+    };
+
+    class SlowlogCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store&,
+                            Client&) override {
+            if (tokens.size() < 2) {
+                return "-ERR wrong number of arguments for 'SLOWLOG' command\r\n";
+            }
+            auto& stats = Stats::getInstance();
+            std::string sub = toUpper(tokens[1]);
+            if (sub == "LEN" && tokens.size() == 2) {
+                return integerReply(static_cast<int64_t>(stats.slowlog().size()));
+            }
+            if (sub == "RESET" && tokens.size() == 2) {
+                stats.resetSlowlog();
+                return "+OK\r\n";
+            }
+            if (sub == "GET" && tokens.size() <= 3) {
+                size_t count = 10;
+                if (tokens.size() == 3) {
+                    try {
+                        int n = std::stoi(std::string(tokens[2]));
+                        count = n < 0 ? stats.slowlog().size() : static_cast<size_t>(n);
+                    } catch (...) {
+                        return "-ERR value is not an integer or out of range\r\n";
+                    }
+                }
+                count = std::min(count, stats.slowlog().size());
+                std::string response = "*" + std::to_string(count) + "\r\n";
+                for (size_t i = 0; i < count; ++i) {
+                    const auto& entry = stats.slowlog()[i];
+                    response += "*4\r\n";
+                    response += integerReply(static_cast<int64_t>(entry.id));
+                    response += integerReply(entry.timestamp);
+                    response += integerReply(static_cast<int64_t>(entry.duration_us));
+                    response += "*" + std::to_string(entry.args.size()) + "\r\n";
+                    for (const auto& arg : entry.args) {
+                        response += bulkString(arg);
+                    }
+                }
+                return response;
+            }
+            return "-ERR unknown subcommand or wrong number of arguments for 'SLOWLOG " +
+                   std::string(tokens[1]) + "'\r\n";
+        }
+    };
+
+    class LatencyCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store&,
+                            Client&) override {
+            if (tokens.size() < 2) {
+                return "-ERR wrong number of arguments for 'LATENCY' command\r\n";
+            }
+            auto& stats = Stats::getInstance();
+            std::string sub = toUpper(tokens[1]);
+            if (sub == "LATEST" && tokens.size() == 2) {
+                const auto& events = stats.latencyEvents();
+                std::string response = "*" + std::to_string(events.size()) + "\r\n";
+                for (const auto& [name, event] : events) {
+                    response += "*4\r\n" + bulkString(name);
+                    response += integerReply(event.latest.timestamp);
+                    response += integerReply(static_cast<int64_t>(event.latest.msec));
+                    response += integerReply(static_cast<int64_t>(event.max));
+                }
+                return response;
+            }
+            if (sub == "HISTORY" && tokens.size() == 3) {
+                const auto& events = stats.latencyEvents();
+                auto it = events.find(tokens[2]);
+                if (it == events.end()) {
+                    return "*0\r\n";
+                }
+                std::string response = "*" + std::to_string(it->second.history.size()) + "\r\n";
+                for (const auto& sample : it->second.history) {
+                    response += "*2\r\n";
+                    response += integerReply(sample.timestamp);
+                    response += integerReply(static_cast<int64_t>(sample.msec));
+                }
+                return response;
+            }
+            if (sub == "RESET") {
+                if (tokens.size() == 2) {
+                    return integerReply(static_cast<int64_t>(stats.resetLatency()));
+                }
+                size_t reset = 0;
+                for (size_t i = 2; i < tokens.size(); ++i) {
+                    reset += stats.resetLatency(tokens[i]);
+                }
+                return integerReply(static_cast<int64_t>(reset));
+            }
+            return "-ERR unknown subcommand or wrong number of arguments for 'LATENCY " +
+                   std::string(tokens[1]) + "'\r\n";
+        }
+    };
+
+    // 解析 COUNT n 选项，失败时返回 false
+    bool parseCount(const std::vector<std::string_view>& tokens, size_t pos, size_t& count) {
+        if (pos == tokens.size()) {
+            return true;
+        }
+        if (pos + 2 != tokens.size() || toUpper(tokens[pos]) != "COUNT") {
+            return false;
+        }
+        try {
+            int n = std::stoi(std::string(tokens[pos + 1]));
+            if (n < 1) {
+                return false;
+            }
+            count = static_cast<size_t>(n);
+        } catch (...) {
+            return false;
+        }
+        return true;
+    }
+
+    class HotkeysCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store&,
+                            Client&) override {
+            auto& hotkeys = HotKeys::getInstance();
+            std::string sub = tokens.size() >= 2 ? toUpper(tokens[1]) : "GET";
+            if (sub == "RESET" && tokens.size() == 2) {
+                hotkeys.reset();
+                return "+OK\r\n";
+            }
+            if (sub == "GET" || sub == "COUNT") {
+                size_t count = 10;
+                // HOTKEYS COUNT n 是 HOTKEYS GET COUNT n 的简写
+                if (!parseCount(tokens, sub == "GET" && tokens.size() >= 2 ? 2 : 1, count)) {
+                    return "-ERR syntax error\r\n";
+                }
+                auto top = hotkeys.top(count);
+                std::string response = "*" + std::to_string(top.size()) + "\r\n";
+                for (const auto& [key, hits] : top) {
+                    response += "*2\r\n" + bulkString(key);
+                    response += integerReply(static_cast<int64_t>(hits));
+                }
+                return response;
+            }
+            return "-ERR unknown subcommand or wrong number of arguments for 'HOTKEYS " +
+                   std::string(tokens[1]) + "'\r\n";
+        }
+    };
+
+    class BigkeysCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store&,
+                            Client&) override {
+            auto& bigkeys = BigKeys::getInstance();
+            std::string sub = tokens.size() >= 2 ? toUpper(tokens[1]) : "STATUS";
+            if (sub == "START") {
+                size_t top = BigKeys::DEFAULT_TOP;
+                if (!parseCount(tokens, 2, top) || top > BigKeys::MAX_TOP) {
+                    return "-ERR syntax error\r\n";
+                }
+                bigkeys.start(top);
+                return "+OK\r\n";
+            }
+            if (sub == "STOP" && tokens.size() == 2) {
+                bigkeys.stop();
+                return "+OK\r\n";
+            }
+            if (sub == "STATUS" && tokens.size() <= 2) {
+                static constexpr const char* states[] = {"idle", "running", "done"};
+                auto biggest = bigkeys.biggest();
+                std::string response = "*8\r\n";
+                response += bulkString("status");
+                response += bulkString(states[static_cast<int>(bigkeys.state())]);
+                response += bulkString("scanned_keys");
+                response += integerReply(static_cast<int64_t>(bigkeys.scannedKeys()));
+                response += bulkString("total_value_bytes");
+                response += integerReply(static_cast<int64_t>(bigkeys.totalBytes()));
+                response += bulkString("biggest");
+                response += "*" + std::to_string(biggest.size()) + "\r\n";
+                for (const auto& [key, size] : biggest) {
+                    response += "*2\r\n" + bulkString(key);
+                    response += integerReply(static_cast<int64_t>(size));
+                }
+                return response;
+            }
+            return "-ERR unknown subcommand or wrong number of arguments for 'BIGKEYS " +
+                   std::string(tokens[1]) + "'\r\n";
+        }
+    };
+
+    class ConfigCommand : public Command {
+    public:
+        std::string execute(const std::vector<std::string_view>& tokens, Store&,
+                            Client& client) override {
+            if (tokens.size() < 2) {
+                return "-ERR wrong number of arguments for 'CONFIG' command\r\n";
+            }
+            auto& config = Config::getInstance();
+            std::string sub = toUpper(tokens[1]);
+            if (sub == "GET" && tokens.size() >= 3) {
+                // 多个模式可能匹配同一个参数，合并去重
+                std::map<std::string, std::string> matched;
+                for (size_t i = 2; i < tokens.size(); ++i) {
+                    for (auto& [name, value] : config.get(tokens[i])) {
+                        matched.emplace(std::move(name), std::move(value));
+                    }
+                }
+                std::string response = client.resp >= 3
+                                           ? "%" + std::to_string(matched.size()) + "\r\n"
+                                           : "*" + std::to_string(matched.size() * 2) + "\r\n";
+                for (const auto& [name, value] : matched) {
+                    response += bulkString(name) + bulkString(value);
+                }
+                return response;
+            }
+            if (sub == "SET" && tokens.size() >= 4 && tokens.size() % 2 == 0) {
+                std::vector<std::pair<std::string, std::string>> pairs;
+                for (size_t i = 2; i < tokens.size(); i += 2) {
+                    pairs.emplace_back(tokens[i], tokens[i + 1]);
+                }
+                std::string err = config.set(pairs, false);
+                return err.empty() ? "+OK\r\n" : "-ERR " + err + "\r\n";
+            }
+            if (sub == "RESETSTAT" && tokens.size() == 2) {
+                Stats::getInstance().resetCommandStats();
+                return "+OK\r\n";
+            }
+            return "-ERR unknown subcommand or wrong number of arguments for 'CONFIG " +
+                   std::string(tokens[1]) + "'\r\n";
+        }
+    };
+
     struct CommandInitializer {
         CommandInitializer() {
             Command::registerCommand("SET", []() { return std::make_unique<SetCommand>(); });
+            Command::registerCommand("SETLZ", []() { return std::make_unique<SetlzCommand>(); });
             Command::registerCommand("GET", []() { return std::make_unique<GetCommand>(); });
             Command::registerCommand("EXPIRE", []() { return std::make_unique<ExpireCommand>(); });
             Command::registerCommand("MULTI", []() { return std::make_unique<MultiCommand>(); });
             Command::registerCommand("EXEC", []() { return std::make_unique<ExecCommand>(); });
             Command::registerCommand("DISCARD",
                                      []() { return std::make_unique<DiscardCommand>(); });
+            Command::registerCommand("DEL", []() { return std::make_unique<DelCommand>(false); });
+            Command::registerCommand("UNLINK", []() { return std::make_unique<DelCommand>(true); });
+            Command::registerCommand("FLUSHDB", []() { return std::make_unique<FlushCommand>(); });
+            Command::registerCommand("FLUSHALL", []() { return std::make_unique<FlushCommand>(); });
+            Command::registerCommand("SCAN", []() { return std::make_unique<ScanCommand>(); });
+            Command::registerCommand("KEYS", []() { return std::make_unique<KeysCommand>(); });
+            Command::registerCommand("CLIENT", []() { return std::make_unique<ClientCommand>(); });
+            Command::registerCommand("HELLO", []() { return std::make_unique<HelloCommand>(); });
+            Command::registerCommand("INFO", []() { return std::make_unique<InfoCommand>(); });
+            Command::registerCommand("SLOWLOG",
+                                     []() { return std::make_unique<SlowlogCommand>(); });
+            Command::registerCommand("LATENCY",
+                                     []() { return std::make_unique<LatencyCommand>(); });
+            Command::registerCommand("HOTKEYS",
+                                     []() { return std::make_unique<HotkeysCommand>(); });
+            Command::registerCommand("BIGKEYS",
+                                     []() { return std::make_unique<BigkeysCommand>(); });
+            Command::registerCommand("CONFIG", []() { return std::make_unique<ConfigCommand>(); });
         }
     } initializer;
 
@@ -0,0 +1,367 @@
+#include "config.hpp"
+
+#include <cctype>
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "glob.hpp"
+#include "hotkeys.hpp"
+#include "stats.hpp"
+#include "tracking.hpp"
+
+namespace {
+    std::string toLower(std::string_view value) {
+        std::string result(value);
+        for (auto& ch : result) {
+            ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        }
+        return result;
+    }
+
+    // 按空白切分一行，支持双引号包裹含空格的值（"" 表示空字符串）
+    std::vector<std::string> splitArgs(const std::string& line) {
+        std::vector<std::string> args;
+        size_t i = 0;
+        while (i < line.size()) {
+            if (std::isspace(static_cast<unsigned char>(line[i]))) {
+                ++i;
+                continue;
+            }
+            std::string arg;
+            if (line[i] == '"') {
+                size_t end = line.find('"', i + 1);
+                if (end == std::string::npos) {
+                    throw std::runtime_error("unbalanced quotes");
+                }
+                arg = line.substr(i + 1, end - i - 1);
+                i = end + 1;
+            } else {
+                while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i]))) {
+                    arg += line[i++];
+                }
+            }
+            args.push_back(std::move(arg));
+        }
+        return args;
+    }
+
+    std::string join(const std::vector<std::string>& values, size_t from) {
+        std::string result;
+        for (size_t i = from; i < values.size(); ++i) {
+            if (i > from) {
+                result += ' ';
+            }
+            result += values[i];
+        }
+        return result;
+    }
+
+    bool parseInt(std::string_view value, int64_t& out, int base = 10) {
+        if (value.empty()) {
+            return false;
+        }
+        try {
+            size_t pos = 0;
+            out = std::stoll(std::string(value), &pos, base);
+            return pos == value.size();
+        } catch (...) {
+            return false;
+        }
+    }
+
+    bool parseMemory(std::string_view value, int64_t& out) {
+        std::string lower = toLower(value);
+        int64_t unit = 1;
+        for (const auto& [suffix, mul] :
+             {std::pair<std::string_view, int64_t>{"kb", 1LL << 10}, {"k", 1LL << 10},
+              {"mb", 1LL << 20}, {"m", 1LL << 20}, {"gb", 1LL << 30}, {"g", 1LL << 30}}) {
+            if (lower.size() > suffix.size() &&
+                lower.compare(lower.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                lower.resize(lower.size() - suffix.size());
+                unit = mul;
+                break;
+            }
+        }
+        if (!parseInt(lower, out) || out > LLONG_MAX / unit) {
+            return false;
+        }
+        out *= unit;
+        return true;
+    }
+}
+
+Config& Config::getInstance() {
+    static Config instance;
+    return instance;
+}
+
+Config::Config() {
+    // 网络：bind/port/unixsocket 只在启动时生效，TCP 选项对之后建立的连接生效
+    addParam(
+        "bind", false,
+        [this]() {
+            std::string result;
+            for (const auto& addr : options_.bind) {
+                result += (result.empty() ? "" : " ") + addr;
+            }
+            return result;
+        },
+        [this](std::string_view value, std::function<void()>& apply) -> std::string {
+            std::istringstream in{std::string(value)};
+            std::vector<std::string> addrs;
+            for (std::string addr; in >> addr;) {
+                addrs.push_back(std::move(addr));
+            }
+            if (addrs.empty()) {
+                return "argument must not be empty";
+            }
+            apply = [this, addrs = std::move(addrs)]() { options_.bind = addrs; };
+            return "";
+        });
+    addInt("port", options_.port, 0, 65535, false);
+    addInt("tcp-backlog", options_.tcp_backlog, 1, INT_MAX, true);
+    addBool("tcp-nodelay", options_.tcp_nodelay, true);
+    addInt("tcp-keepalive", options_.tcp_keepalive, 0, INT_MAX, true);
+    // 最终传给 setsockopt 的 int
+    addMemory("so-sndbuf", options_.so_sndbuf, INT_MAX, true);
+    addMemory("so-rcvbuf", options_.so_rcvbuf, INT_MAX, true);
+    addString("unixsocket", options_.unixsocket, false);
+    // 权限按八进制读写，与 chmod 一致
+    addParam(
+        "unixsocketperm", false,
+        [this]() {
+            std::ostringstream out;
+            out << std::oct << options_.unixsocketperm;
+            return out.str();
+        },
+        [this](std::string_view value, std::function<void()>& apply) -> std::string {
+            int64_t perm;
+            if (!parseInt(value, perm, 8) || perm < 0 || perm > 0777) {
+                return "argument must be an octal number between 0 and 777";
+            }
+            apply = [this, perm]() { options_.unixsocketperm = perm; };
+            return "";
+        });
+
+    addInt("timeout", options_.timeout, 0, INT_MAX, true);
+    addInt("maxclients", options_.maxclients, 1, INT_MAX, true);
+    addBool("epoll-edge-triggered", options_.epoll_edge_triggered, false);
+    addInt("hz", options_.hz, 1, 500, true);
+
+    // 持久化
+    addString("dir", options_.dir, false);
+    addString("appendfilename", options_.appendfilename, false);
+    addParam(
+        "appendfsync", true, [this]() { return options_.appendfsync; },
+        [this](std::string_view value, std::function<void()>& apply) -> std::string {
+            std::string lower = toLower(value);
+            if (lower != "always" && lower != "everysec" && lower != "no") {
+                return "argument must be one of 'always', 'everysec', 'no'";
+            }
+            apply = [this, lower]() { options_.appendfsync = lower; };
+            return "";
+        });
+    addBool("lazyfree-lazy-expire", options_.lazyfree_lazy_expire, true);
+    addBool("lazyfree-lazy-server-del", options_.lazyfree_lazy_server_del, true);
+    addBool("lazyfree-lazy-user-del", options_.lazyfree_lazy_user_del, true);
+
+    // value 压缩
+    addBool("value-compression", options_.value_compression, true);
+    addMemory("value-compression-threshold", options_.value_compression_threshold, LLONG_MAX,
+              true);
+
+    // 分层存储
+    addBool("tiered-storage", options_.tiered_storage, false);
+    addString("tiered-storage-path", options_.tiered_storage_path, false);
+    addMemory("tiered-max-memory", options_.tiered_max_memory, LLONG_MAX, true);
+    addMemory("tiered-min-value-size", options_.tiered_min_value_size, LLONG_MAX, true);
+    addInt("tiered-compact-garbage-ratio", options_.tiered_compact_garbage_ratio, 1, 100, true);
+
+    // 其他模块自己保存的参数
+    auto& stats = Stats::getInstance();
+    addInt(
+        "slowlog-log-slower-than", [&stats]() { return stats.slowlogThreshold(); },
+        [&stats](int64_t v) { stats.setSlowlogThreshold(v); }, -1, LLONG_MAX, true);
+    addInt(
+        "slowlog-max-len", [&stats]() { return static_cast<int64_t>(stats.slowlogMaxLen()); },
+        [&stats](int64_t v) { stats.setSlowlogMaxLen(static_cast<size_t>(v)); }, 0, LLONG_MAX,
+        true);
+    addInt(
+        "latency-monitor-threshold",
+        [&stats]() { return static_cast<int64_t>(stats.latencyThreshold()); },
+        [&stats](int64_t v) { stats.setLatencyThreshold(static_cast<uint64_t>(v)); }, 0,
+        LLONG_MAX, true);
+    addInt(
+        "tracking-table-max-keys",
+        []() { return static_cast<int64_t>(Tracking::getInstance().maxKeys()); },
+        [](int64_t v) { Tracking::getInstance().setMaxKeys(static_cast<size_t>(v)); }, 1,
+        LLONG_MAX, true);
+    addInt(
+        "hotkeys-sample-rate",
+        []() { return static_cast<int64_t>(HotKeys::getInstance().sampleRate()); },
+        [](int64_t v) { HotKeys::getInstance().setSampleRate(static_cast<uint64_t>(v)); }, 1,
+        1 << 20, true);
+}
+
+void Config::addParam(const std::string& name, bool runtime, std::function<std::string()> get,
+                      std::function<std::string(std::string_view, std::function<void()>&)> parse) {
+    params_.emplace(name, Param{runtime, std::move(get), std::move(parse)});
+}
+
+void Config::addBool(const std::string& name, bool& field, bool runtime) {
+    addParam(
+        name, runtime, [&field]() { return std::string(field ? "yes" : "no"); },
+        [&field](std::string_view value, std::function<void()>& apply) -> std::string {
+            std::string lower = toLower(value);
+            if (lower != "yes" && lower != "no") {
+                return "argument must be 'yes' or 'no'";
+            }
+            apply = [&field, on = lower == "yes"]() { field = on; };
+            return "";
+        });
+}
+
+void Config::addInt(const std::string& name, std::function<int64_t()> get,
+                    std::function<void(int64_t)> set, int64_t min, int64_t max, bool runtime) {
+    addParam(
+        name, runtime, [get]() { return std::to_string(get()); },
+        [set, min, max](std::string_view value, std::function<void()>& apply) -> std::string {
+            int64_t v;
+            if (!parseInt(value, v) || v < min || v > max) {
+                return "argument must be an integer between " + std::to_string(min) + " and " +
+                       std::to_string(max);
+            }
+            apply = [set, v]() { set(v); };
+            return "";
+        });
+}
+
+void Config::addInt(const std::string& name, int64_t& field, int64_t min, int64_t max,
+                    bool runtime) {
+    addInt(
+        name, [&field]() { return field; }, [&field](int64_t v) { field = v; }, min, max,
+        runtime);
+}
+
+void Config::addMemory(const std::string& name, int64_t& field, int64_t max, bool runtime) {
+    addParam(
+        name, runtime, [&field]() { return std::to_string(field); },
+        [&field, max](std::string_view value, std::function<void()>& apply) -> std::string {
+            int64_t v;
+            if (!parseMemory(value, v) || v < 0 || v > max) {
+                return "argument must be a memory value";
+            }
+            apply = [&field, v]() { field = v; };
+            return "";
+        });
+}
+
+void Config::addString(const std::string& name, std::string& field, bool runtime) {
+    addParam(
+        name, runtime, [&field]() { return field; },
+        [&field](std::string_view value, std::function<void()>& apply) -> std::string {
+            apply = [&field, str = std::string(value)]() { field = str; };
+            return "";
+        });
+}
+
+std::string Config::set(const std::vector<std::pair<std::string, std::string>>& pairs,
+                        bool startup) {
+    // 先校验全部参数，都合法后才生效：生效操作可能有无法撤销的副作用
+    // （如 tracking-table-max-keys 调小时淘汰 key 并发送失效通知），不能事后回滚
+    std::vector<std::function<void()>> applies;
+    applies.reserve(pairs.size());
+    for (const auto& [name, value] : pairs) {
+        auto it = params_.find(toLower(name));
+        if (it == params_.end()) {
+            return "Unknown option '" + name + "'";
+        }
+        if (!startup && !it->second.mutable_at_runtime) {
+            return "CONFIG SET failed (possibly related to argument '" + name +
+                   "') - can't set immutable config";
+        }
+        std::function<void()> apply;
+        std::string err = it->second.parse(value, apply);
+        if (!err.empty()) {
+            return startup ? "Invalid value for '" + name + "': " + err
+                           : "CONFIG SET failed (possibly related to argument '" + name + "') - " +
+                                 err;
+        }
+        applies.push_back(std::move(apply));
+    }
+    for (const auto& apply : applies) {
+        apply();
+    }
+
+    if (!startup && on_change_) {
+        for (const auto& [name, value] : pairs) {
+            on_change_(toLower(name));
+        }
+    }
+    return "";
+}
+
+std::vector<std::pair<std::string, std::string>> Config::get(std::string_view pattern) const {
+    std::string lower = toLower(pattern);
+    std::vector<std::pair<std::string, std::string>> result;
+    for (const auto& [name, param] : params_) {
+        if (globMatch(lower, name)) {
+            result.emplace_back(name, param.get());
+        }
+    }
+    return result;
+}
+
+void Config::loadFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open config file: " + path);
+    }
+    std::string line;
+    for (int lineno = 1; std::getline(in, line); ++lineno) {
+        try {
+            auto args = splitArgs(line);
+            if (args.empty() || args[0][0] == '#') {
+                continue;
+            }
+            if (args.size() < 2) {
+                throw std::runtime_error("wrong number of arguments");
+            }
+            std::string err = set({{args[0], join(args, 1)}}, true);
+            if (!err.empty()) {
+                throw std::runtime_error(err);
+            }
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error(path + ":" + std::to_string(lineno) + ": " + e.what());
+        }
+    }
+}
+
+void Config::parseArgs(int argc, char* argv[]) {
+    int i = 1;
+    if (i < argc && std::string_view(argv[i]).substr(0, 2) != "--") {
+        loadFile(argv[i++]);
+    }
+    // --name 之后直到下一个 --name 的参数都属于该选项，例如 --bind 127.0.0.1 ::1
+    std::vector<std::pair<std::string, std::string>> pairs;
+    while (i < argc) {
+        std::string_view arg = argv[i++];
+        if (arg.substr(0, 2) != "--" || arg.size() == 2) {
+            throw std::runtime_error("Invalid argument: " + std::string(arg));
+        }
+        std::vector<std::string> values;
+        while (i < argc && std::string_view(argv[i]).substr(0, 2) != "--") {
+            values.emplace_back(argv[i++]);
+        }
+        if (values.empty()) {
+            throw std::runtime_error("Missing value for " + std::string(arg));
+        }
+        pairs.emplace_back(std::string(arg.substr(2)), join(values, 0));
+    }
+    std::string err = set(pairs, true);
+    if (!err.empty()) {
+        throw std::runtime_error(err);
+    }
+}
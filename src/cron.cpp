@@ -0,0 +1,65 @@
+#include "cron.hpp"
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "stats.hpp"
+
+Cron::Cron(int hz) : hz_(hz) {
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd_ < 0) {
+        throw std::runtime_error("Failed to create timerfd");
+    }
+    setHz(hz);
+}
+
+Cron::~Cron() { close(timer_fd_); }
+
+void Cron::setHz(int hz) {
+    hz_ = hz;
+    long interval_ns = 1000000000L / hz;
+    itimerspec spec{};
+    spec.it_interval.tv_sec = interval_ns / 1000000000L;
+    spec.it_interval.tv_nsec = interval_ns % 1000000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(timer_fd_, 0, &spec, nullptr) < 0) {
+        throw std::runtime_error("Failed to arm timerfd");
+    }
+}
+
+void Cron::addJob(std::string name, std::chrono::milliseconds period,
+                  std::chrono::microseconds budget, Job fn) {
+    jobs_.push_back({std::move(name), period, budget, std::move(fn), Clock::now() + period});
+}
+
+void Cron::onTimer() {
+    // 读出到期次数以清除可读状态；错过的时间片不补执行
+    uint64_t expirations;
+    if (read(timer_fd_, &expirations, sizeof(expirations)) < 0) {
+        return;
+    }
+
+    auto& stats = Stats::getInstance();
+    for (auto& job : jobs_) {
+        auto start = Clock::now();
+        if (start < job.next_run) {
+            continue;
+        }
+        job.fn(start + job.budget);
+        auto end = Clock::now();
+
+        // 落后超过一个周期时从当前时间重新计时，避免连续补跑
+        job.next_run += job.period;
+        if (job.next_run <= end) {
+            job.next_run = end + job.period;
+        }
+
+        auto usec = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        stats.recordCronJob(job.name, static_cast<uint64_t>(usec.count()),
+                            usec > job.budget);
+        stats.recordLatency(job.name, static_cast<uint64_t>(usec.count() / 1000));
+    }
+}
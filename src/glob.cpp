@@ -0,0 +1,105 @@
+#include "glob.hpp"
+
+#include <cstddef>
+#include <utility>
+
+namespace {
+    // 匹配 pattern[p] 开始的 [...] 字符集，成功时 p 指向 ']' 之后
+    bool matchClass(std::string_view pattern, size_t& p, char c) {
+        ++p;  // 跳过 '['
+        bool negate = p < pattern.size() && pattern[p] == '^';
+        if (negate) {
+            ++p;
+        }
+        bool matched = false;
+        while (p < pattern.size() && pattern[p] != ']') {
+            if (pattern[p] == '\\' && p + 1 < pattern.size()) {
+                ++p;
+                matched = matched || pattern[p] == c;
+            } else if (p + 2 < pattern.size() && pattern[p + 1] == '-' && pattern[p + 2] != ']') {
+                char lo = pattern[p], hi = pattern[p + 2];
+                if (lo > hi) {
+                    std::swap(lo, hi);
+                }
+                matched = matched || (c >= lo && c <= hi);
+                p += 2;
+            } else {
+                matched = matched || pattern[p] == c;
+            }
+            ++p;
+        }
+        if (p < pattern.size()) {
+            ++p;  // 跳过 ']'
+        }
+        return negate ? !matched : matched;
+    }
+}
+
+bool globMatch(std::string_view pattern, std::string_view str) {
+    size_t p = 0, s = 0;
+    size_t star_p = std::string_view::npos, star_s = 0;
+
+    while (s < str.size()) {
+        if (p < pattern.size()) {
+            char pc = pattern[p];
+            if (pc == '*') {
+                // 连续的 * 等价于一个
+                while (p < pattern.size() && pattern[p] == '*') {
+                    ++p;
+                }
+                if (p == pattern.size()) {
+                    return true;
+                }
+                star_p = p;
+                star_s = s;
+                continue;
+            }
+            if (pc == '?') {
+                ++p;
+                ++s;
+                continue;
+            }
+            if (pc == '[') {
+                size_t next = p;
+                if (matchClass(pattern, next, str[s])) {
+                    p = next;
+                    ++s;
+                    continue;
+                }
+            } else {
+                if (pc == '\\' && p + 1 < pattern.size()) {
+                    pc = pattern[p + 1];
+                    if (pc == str[s]) {
+                        p += 2;
+                        ++s;
+                        continue;
+                    }
+                } else if (pc == str[s]) {
+                    ++p;
+                    ++s;
+                    continue;
+                }
+            }
+        }
+        // 失配：回到最近的 *，让它多吞一个字符
+        if (star_p == std::string_view::npos) {
+            return false;
+        }
+        p = star_p;
+        s = ++star_s;
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+bool globIsLiteral(std::string_view pattern) {
+    for (char c : pattern) {
+        if (c == '*' || c == '?' || c == '[' || c == '\\') {
+            return false;
+        }
+    }
+    return true;
+}
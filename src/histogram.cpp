@@ -0,0 +1,74 @@
+#include "histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+Histogram::Histogram() { reset(); }
+
+void Histogram::record(uint64_t value) {
+    ++counts_[indexOf(value)];
+    ++count_;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void Histogram::merge(const Histogram& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void Histogram::reset() {
+    counts_.fill(0);
+    count_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+}
+
+uint64_t Histogram::percentile(double p) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    p = std::clamp(p, 0.0, 100.0);
+    uint64_t target = static_cast<uint64_t>(p / 100.0 * static_cast<double>(count_) + 0.5);
+    target = std::clamp<uint64_t>(target, 1, count_);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += counts_[i];
+        if (seen >= target) {
+            // 桶上界可能超过真实最大值，截断到 max_
+            return std::min(highestEquivalent(i), max_);
+        }
+    }
+    return max_;
+}
+
+size_t Histogram::indexOf(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+    // value >= 2^7 时，保留最高的 7 位有效数字
+    int msb = 63 - std::countl_zero(value);
+    int shift = msb - (SUB_BUCKET_BITS - 1);
+    uint64_t sub = value >> shift;  // [64, 128)
+    return SUB_BUCKET_COUNT + static_cast<size_t>(shift - 1) * SUB_BUCKET_HALF +
+           static_cast<size_t>(sub - SUB_BUCKET_HALF);
+}
+
+uint64_t Histogram::highestEquivalent(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    size_t offset = index - SUB_BUCKET_COUNT;
+    int shift = static_cast<int>(offset / SUB_BUCKET_HALF) + 1;
+    uint64_t sub = offset % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+    return ((sub + 1) << shift) - 1;  // 最高桶溢出后回绕为 UINT64_MAX
+}
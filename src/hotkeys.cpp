@@ -0,0 +1,140 @@
+#include "hotkeys.hpp"
+
+#include <algorithm>
+
+HotKeys& HotKeys::getInstance() {
+    static HotKeys instance;
+    return instance;
+}
+
+HotKeys::HotKeys() : sketch_(SKETCH_DEPTH * SKETCH_WIDTH, 0) { heap_.reserve(TOP_K); }
+
+void HotKeys::setSampleRate(uint64_t rate) {
+    uint64_t pow2 = 1;
+    while (pow2 < rate) {
+        pow2 <<= 1;
+    }
+    sample_mask_ = pow2 - 1;
+}
+
+void HotKeys::reset() {
+    std::fill(sketch_.begin(), sketch_.end(), 0);
+    heap_.clear();
+    index_.clear();
+    sampled_ = 0;
+    since_decay_ = 0;
+}
+
+void HotKeys::sample(std::string_view key) {
+    ++sampled_;
+    if (++since_decay_ >= DECAY_INTERVAL) {
+        decay();
+    }
+    uint32_t estimate = increment(key);
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        // 计数只增不减，在最小堆中只可能下沉
+        heap_[it->second].count = estimate;
+        siftDown(it->second);
+        return;
+    }
+    if (heap_.size() < TOP_K) {
+        heap_.push_back({std::string(key), estimate});
+        index_.emplace(heap_.back().key, heap_.size() - 1);
+        siftUp(heap_.size() - 1);
+        return;
+    }
+    if (estimate <= heap_[0].count) {
+        return;
+    }
+    // 替换堆顶（top-K 中最冷的键）
+    index_.erase(heap_[0].key);
+    heap_[0] = {std::string(key), estimate};
+    index_.emplace(heap_[0].key, 0);
+    siftDown(0);
+}
+
+uint32_t HotKeys::increment(std::string_view key) {
+    uint64_t h = std::hash<std::string_view>{}(key);
+    // double hashing：由一次哈希派生各行下标
+    uint32_t h1 = static_cast<uint32_t>(h);
+    uint32_t h2 = static_cast<uint32_t>(h >> 32) | 1;
+    size_t idx[SKETCH_DEPTH];
+    uint32_t min = UINT32_MAX;
+    for (size_t row = 0; row < SKETCH_DEPTH; ++row) {
+        idx[row] = row * SKETCH_WIDTH + ((h1 + row * h2) & (SKETCH_WIDTH - 1));
+        min = std::min(min, sketch_[idx[row]]);
+    }
+    if (min == UINT32_MAX) {
+        return min;
+    }
+    for (size_t row = 0; row < SKETCH_DEPTH; ++row) {
+        if (sketch_[idx[row]] == min) {
+            ++sketch_[idx[row]];
+        }
+    }
+    return min + 1;
+}
+
+void HotKeys::decay() {
+    since_decay_ = 0;
+    for (auto& counter : sketch_) {
+        counter >>= 1;
+    }
+    // 减半是单调变换，堆序保持不变
+    for (auto& item : heap_) {
+        item.count >>= 1;
+    }
+}
+
+std::vector<std::pair<std::string, uint64_t>> HotKeys::top(size_t count) const {
+    std::vector<const Item*> items;
+    items.reserve(heap_.size());
+    for (const auto& item : heap_) {
+        items.push_back(&item);
+    }
+    std::sort(items.begin(), items.end(),
+              [](const Item* a, const Item* b) { return a->count > b->count; });
+    std::vector<std::pair<std::string, uint64_t>> result;
+    for (size_t i = 0; i < items.size() && i < count; ++i) {
+        result.emplace_back(items[i]->key, items[i]->count * sampleRate());
+    }
+    return result;
+}
+
+void HotKeys::siftUp(size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (heap_[parent].count <= heap_[i].count) {
+            break;
+        }
+        swapItems(i, parent);
+        i = parent;
+    }
+}
+
+void HotKeys::siftDown(size_t i) {
+    while (true) {
+        size_t smallest = i;
+        size_t left = i * 2 + 1;
+        size_t right = left + 1;
+        if (left < heap_.size() && heap_[left].count < heap_[smallest].count) {
+            smallest = left;
+        }
+        if (right < heap_.size() && heap_[right].count < heap_[smallest].count) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        swapItems(i, smallest);
+        i = smallest;
+    }
+}
+
+void HotKeys::swapItems(size_t a, size_t b) {
+    std::swap(heap_[a], heap_[b]);
+    index_.find(heap_[a].key)->second = a;
+    index_.find(heap_[b].key)->second = b;
+}
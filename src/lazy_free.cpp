@@ -0,0 +1,45 @@
+#include "lazy_free.hpp"
+
+LazyFree::LazyFree() : worker_(&LazyFree::loop, this) {}
+
+LazyFree::~LazyFree() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    worker_.join();
+}
+
+void LazyFree::enqueue(std::unique_ptr<Garbage> garbage, size_t objects) {
+    garbage->objects = objects;
+    pending_objects_.fetch_add(objects, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(garbage));
+    }
+    cv_.notify_one();
+}
+
+void LazyFree::loop() {
+    std::vector<std::unique_ptr<Garbage>> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;  // stop_ 且队列已清空
+            }
+            batch.swap(queue_);
+        }
+
+        // 在锁外析构，事件循环入队时不会被阻塞
+        for (auto& garbage : batch) {
+            size_t objects = garbage->objects;
+            garbage.reset();
+            pending_objects_.fetch_sub(objects, std::memory_order_relaxed);
+            freed_objects_.fetch_add(objects, std::memory_order_relaxed);
+        }
+        batch.clear();
+    }
+}
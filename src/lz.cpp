@@ -0,0 +1,198 @@
+#include "lz.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    constexpr int HASH_BITS{12};
+    constexpr size_t MIN_MATCH{4};
+    constexpr size_t MAX_OFFSET{65535};
+    // 末尾这些字节总是作为字面量输出，保证匹配扩展时可以整字读取
+    constexpr size_t LAST_LITERALS{8};
+    constexpr size_t MIN_INPUT{32};
+
+    uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint64_t read64(const uint8_t* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint32_t hash(uint32_t v) { return (v * 2654435761u) >> (32 - HASH_BITS); }
+
+    uint8_t* writeLength(uint8_t* op, size_t len) {
+        for (; len >= 255; len -= 255) {
+            *op++ = 255;
+        }
+        *op++ = static_cast<uint8_t>(len);
+        return op;
+    }
+
+    bool readLength(const uint8_t*& ip, const uint8_t* iend, size_t& len) {
+        uint8_t b;
+        do {
+            if (ip >= iend) {
+                return false;
+            }
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+        return true;
+    }
+
+    // 输出一个序列，match_len 为 0 表示最后一个只有字面量的序列；空间不足时返回 nullptr
+    uint8_t* writeSequence(uint8_t* op, uint8_t* oend, const uint8_t* literals, size_t literal_len,
+                           size_t offset, size_t match_len) {
+        size_t worst = 1 + literal_len / 255 + 1 + literal_len + 2 + match_len / 255 + 1;
+        if (worst > static_cast<size_t>(oend - op)) {
+            return nullptr;
+        }
+        uint8_t* token = op++;
+        size_t ml = match_len ? match_len - MIN_MATCH : 0;
+        *token = static_cast<uint8_t>((std::min<size_t>(literal_len, 15) << 4) |
+                                      std::min<size_t>(ml, 15));
+        if (literal_len >= 15) {
+            op = writeLength(op, literal_len - 15);
+        }
+        std::memcpy(op, literals, literal_len);
+        op += literal_len;
+        if (match_len == 0) {
+            return op;
+        }
+        *op++ = static_cast<uint8_t>(offset);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        if (ml >= 15) {
+            op = writeLength(op, ml - 15);
+        }
+        return op;
+    }
+}
+
+bool lzCompress(std::string_view in, size_t max_size, std::string& out) {
+    if (in.size() < MIN_INPUT) {
+        return false;
+    }
+    out.resize(max_size);
+    auto* base = reinterpret_cast<const uint8_t*>(in.data());
+    const uint8_t* end = base + in.size();
+    const uint8_t* limit = end - LAST_LITERALS;
+    auto* op = reinterpret_cast<uint8_t*>(out.data());
+    uint8_t* oend = op + max_size;
+
+    uint32_t table[1 << HASH_BITS] = {};
+    const uint8_t* ip = base + 1;
+    const uint8_t* anchor = base;
+    size_t misses = 0;
+    while (ip < limit) {
+        uint32_t seq = read32(ip);
+        uint32_t h = hash(seq);
+        const uint8_t* candidate = base + table[h];
+        table[h] = static_cast<uint32_t>(ip - base);
+        if (static_cast<size_t>(ip - candidate) > MAX_OFFSET || read32(candidate) != seq) {
+            // 连续未命中时加大步长，快速跳过不可压缩的区域
+            ip += 1 + (misses++ >> 5);
+            continue;
+        }
+        misses = 0;
+        while (ip > anchor && candidate > base && ip[-1] == candidate[-1]) {
+            --ip;
+            --candidate;
+        }
+        const uint8_t* mp = ip + MIN_MATCH;
+        const uint8_t* cp = candidate + MIN_MATCH;
+        // 每次比较 8 字节，第一个不同的字节由异或结果的低位 0 的个数得出
+        while (true) {
+            if (mp + 8 > limit) {
+                while (mp < limit && *mp == *cp) {
+                    ++mp;
+                    ++cp;
+                }
+                break;
+            }
+            uint64_t diff = read64(mp) ^ read64(cp);
+            if (diff != 0) {
+                mp += __builtin_ctzll(diff) >> 3;
+                break;
+            }
+            mp += 8;
+            cp += 8;
+        }
+
+        op = writeSequence(op, oend, anchor, static_cast<size_t>(ip - anchor),
+                           static_cast<size_t>(ip - candidate), static_cast<size_t>(mp - ip));
+        if (!op) {
+            return false;
+        }
+        ip = mp;
+        anchor = ip;
+        // 补记匹配末尾附近的位置，提高下一次命中的概率
+        if (ip < limit) {
+            table[hash(read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - base);
+        }
+    }
+
+    op = writeSequence(op, oend, anchor, static_cast<size_t>(end - anchor), 0, 0);
+    if (!op) {
+        return false;
+    }
+    out.resize(static_cast<size_t>(op - reinterpret_cast<uint8_t*>(out.data())));
+    return true;
+}
+
+bool lzDecompress(std::string_view in, char* out, size_t out_size) {
+    auto* ip = reinterpret_cast<const uint8_t*>(in.data());
+    const uint8_t* iend = ip + in.size();
+    auto* op = reinterpret_cast<uint8_t*>(out);
+    uint8_t* ostart = op;
+    uint8_t* oend = op + out_size;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        size_t literal_len = token >> 4;
+        if (literal_len == 15 && !readLength(ip, iend, literal_len)) {
+            return false;
+        }
+        if (literal_len > static_cast<size_t>(iend - ip) ||
+            literal_len > static_cast<size_t>(oend - op)) {
+            return false;
+        }
+        std::memcpy(op, ip, literal_len);
+        ip += literal_len;
+        op += literal_len;
+        if (ip == iend) {
+            break;  // 最后一个序列只有字面量
+        }
+
+        if (iend - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        size_t match_len = token & 15;
+        if (match_len == 15 && !readLength(ip, iend, match_len)) {
+            return false;
+        }
+        match_len += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(op - ostart) ||
+            match_len > static_cast<size_t>(oend - op)) {
+            return false;
+        }
+        const uint8_t* match = op - offset;
+        if (offset >= match_len) {
+            std::memcpy(op, match, match_len);
+            op += match_len;
+        } else {
+            // 重叠复制（如连续重复的字符），只能逐字节进行
+            for (size_t i = 0; i < match_len; ++i) {
+                *op++ = match[i];
+            }
+        }
+    }
+    return op == oend;
+}
@@ -1,8 +1,32 @@
+#include <unistd.h>
+
+#include <iostream>
+
+#include "config.hpp"
 #include "server.hpp"
 
-int main() {
-    Server server(6379, "aof.log");
-    server.run();
+int main(int argc, char* argv[]) {
+    if (argc == 2 && (std::string_view(argv[1]) == "-h" || std::string_view(argv[1]) == "--help")) {
+        std::cout << "Usage: mini-redis [/path/to/mini-redis.conf] [--name value ...]\n"
+                  << "Examples:\n"
+                  << "  mini-redis --port 6380 --bind 127.0.0.1 ::1\n"
+                  << "  mini-redis mini-redis.conf --unixsocket /tmp/mini-redis.sock\n";
+        return 0;
+    }
+
+    try {
+        auto& config = Config::getInstance();
+        config.parseArgs(argc, argv);
+        // AOF 等相对路径都相对于 dir
+        if (chdir(config.options().dir.c_str()) < 0) {
+            throw std::runtime_error("Can't chdir to '" + config.options().dir + "'");
+        }
+        Server server(config);
+        server.run();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
 
     return 0;
 }
@@ -0,0 +1,89 @@
+#include "reply_buffer.hpp"
+
+#include <utility>
+
+size_t ReplyBuffer::capacity() const {
+    size_t total = 0;
+    for (const auto& chunk : chunks_) {
+        total += chunk.copied.capacity();
+    }
+    return total;
+}
+
+void ReplyBuffer::append(std::string_view data) {
+    if (data.empty()) {
+        return;
+    }
+    if (chunks_.empty() || chunks_.back().shared.size() ||
+        chunks_.back().copied.size() >= CHUNK_SIZE) {
+        chunks_.emplace_back();
+    }
+    chunks_.back().copied.append(data);
+    size_ += data.size();
+}
+
+void ReplyBuffer::append(SharedBuffer data) {
+    if (data.size() < REFERENCE_THRESHOLD) {
+        append(data.view());
+        return;
+    }
+    size_ += data.size();
+    chunks_.emplace_back();
+    chunks_.back().shared = std::move(data);
+}
+
+int ReplyBuffer::prepare(iovec* iov, int max_iov) const {
+    int count = 0;
+    for (size_t i = head_; i < chunks_.size() && count < max_iov; ++i) {
+        std::string_view data = chunks_[i].pending();
+        if (data.empty()) {
+            continue;
+        }
+        iov[count].iov_base = const_cast<char*>(data.data());
+        iov[count].iov_len = data.size();
+        ++count;
+    }
+    return count;
+}
+
+void ReplyBuffer::consume(size_t bytes) {
+    size_ -= bytes;
+    while (bytes > 0) {
+        Chunk& chunk = chunks_[head_];
+        size_t pending = chunk.pending().size();
+        if (bytes < pending) {
+            chunk.sent += bytes;
+            return;
+        }
+        bytes -= pending;
+        chunk.sent += pending;
+        // 尽早放下引用，被覆盖的 value 可以立即释放
+        chunk.shared = SharedBuffer();
+        ++head_;
+    }
+
+    if (size_ == 0) {
+        // 全部发完：保留第一个拷贝块的内存，供下一批小响应复用
+        std::string spare;
+        if (!chunks_.empty()) {
+            spare = std::move(chunks_.front().copied);
+            spare.clear();
+        }
+        chunks_.clear();
+        head_ = 0;
+        if (spare.capacity() > 0) {
+            chunks_.emplace_back();
+            chunks_.back().copied = std::move(spare);
+        }
+    } else if (head_ >= 64 && head_ * 2 >= chunks_.size()) {
+        // 对端读得慢时，已发送的块不能无限堆积
+        chunks_.erase(chunks_.begin(), chunks_.begin() + static_cast<std::ptrdiff_t>(head_));
+        head_ = 0;
+    }
+}
+
+void ReplyBuffer::clear() {
+    std::vector<Chunk>().swap(chunks_);
+    head_ = 0;
+    size_ = 0;
+}
@@ -9,16 +9,40 @@ RingBuffer::RingBuffer(size_t capacity) : capacity_(capacity), head_(0), tail_(0
 
 RingBuffer::~RingBuffer() { delete[] buffer_; }
 
+RingBuffer::RingBuffer(RingBuffer&& other) noexcept
+    : buffer_(other.buffer_), capacity_(other.capacity_), head_(other.head_), tail_(other.tail_) {
+    other.buffer_ = nullptr;
+    other.capacity_ = other.head_ = other.tail_ = 0;
+}
+
+RingBuffer& RingBuffer::operator=(RingBuffer&& other) noexcept {
+    if (this != &other) {
+        delete[] buffer_;
+        buffer_ = other.buffer_;
+        capacity_ = other.capacity_;
+        head_ = other.head_;
+        tail_ = other.tail_;
+        other.buffer_ = nullptr;
+        other.capacity_ = other.head_ = other.tail_ = 0;
+    }
+    return *this;
+}
+
 bool RingBuffer::write(const char* data, size_t len) {
-    if (len > available()) {
-        size_t new_capacity = std::max(capacity_ * 2, capacity_ + len);
+    if (len == 0) {
+        return true;
+    }
+    // Keep at least one free byte so that head_ == tail_ always means empty
+    // (a moved-from buffer has capacity 0, so the +1 is needed there too)
+    if (len >= available()) {
+        size_t new_capacity = std::max(capacity_ * 2, capacity_ + len + 1);
         resize(new_capacity);
     }
 
     size_t space_to_end = capacity_ - tail_;
     if (len <= space_to_end) {
         std::memcpy(buffer_ + tail_, data, len);
-        tail_ += len;
+        tail_ = (tail_ + len) % capacity_;
     } else {
         std::memcpy(buffer_ + tail_, data, space_to_end);
         std::memcpy(buffer_, data + space_to_end, len - space_to_end);
@@ -27,28 +51,26 @@ bool RingBuffer::write(const char* data, size_t len) {
     return true;
 }
 
-std::string_view RingBuffer::peek(size_t offset, size_t len) const {
-    if (offset + len > size()) {
+std::string_view RingBuffer::peek(size_t offset, size_t len) {
+    if (offset + len > size() || len == 0) {
         return {};
     }
     size_t pos = (head_ + offset) % capacity_;
-    if (pos + len <= capacity_) {
-        return std::string_view(buffer_ + pos, len);
+    if (pos + len > capacity_) {
+        // Handle wrap-around: the view must point into owned memory
+        linearize();
+        pos = offset;
     }
-    // Handle wrap-around
-    char* temp = new char[len];
-    size_t first_part = capacity_ - pos;
-    std::memcpy(temp, buffer_ + pos, first_part);
-    std::memcpy(temp + first_part, buffer_, len - first_part);
-    std::string_view result(temp, len);
-    delete[] temp;
-    return result;
+    return std::string_view(buffer_ + pos, len);
 }
 
 void RingBuffer::consume(size_t len) {
     if (len > size()) {
         len = size();
     }
+    if (len == 0) {
+        return;  // Also covers a moved-from buffer, whose capacity is 0
+    }
     head_ = (head_ + len) % capacity_;
     if (head_ == tail_) {
         head_ = tail_ = 0;  // Reset to avoid fragmentation
@@ -64,6 +86,15 @@ size_t RingBuffer::size() const {
 
 size_t RingBuffer::available() const { return capacity_ - size(); }
 
+void RingBuffer::linearize() { resize(capacity_); }
+
+void RingBuffer::shrink(size_t min_capacity) {
+    size_t target = std::max(min_capacity, size() + 1);
+    if (target < capacity_) {
+        resize(target);
+    }
+}
+
 void RingBuffer::resize(size_t new_capacity) {
     char* new_buffer = new char[new_capacity];
     size_t data_size = size();
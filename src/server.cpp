@@ -1,224 +1,714 @@
 #include "server.hpp"
 
+#include <arpa/inet.h>
 #include <errno.h>
-#include <fcntl.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
+#include "bigkeys.hpp"
 #include "ring_buffer.hpp"
+#include "stats.hpp"
+#include "tracking.hpp"
 
-Server::Server(int port, const std::string& aof_file) : store_(aof_file) {
-    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd_ < 0) {
-        throw std::runtime_error("Failed to create socket");
+namespace {
+    size_t compressThreshold(const Config::Options& options) {
+        return options.value_compression
+                   ? static_cast<size_t>(std::max<int64_t>(options.value_compression_threshold, 1))
+                   : 0;
     }
 
-    int opt = 1;
-    if (setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        close(server_fd_);
-        throw std::runtime_error("Failed to set socket options");
+    TieredOptions tieredOptions(const Config::Options& options) {
+        TieredOptions tiered;
+        if (options.tiered_storage) {
+            tiered.path = options.tiered_storage_path;
+        }
+        tiered.max_memory = static_cast<size_t>(options.tiered_max_memory);
+        tiered.min_value_size = static_cast<size_t>(options.tiered_min_value_size);
+        tiered.compact_garbage_percent = static_cast<int>(options.tiered_compact_garbage_ratio);
+        return tiered;
     }
+}
 
-    setNonBlocking(server_fd_);
+Server::Server(Config& config)
+    : config_(config),
+      edge_triggered_(config.options().epoll_edge_triggered),
+      store_(config.options().appendfilename, compressThreshold(config.options()),
+             tieredOptions(config.options())),
+      cron_(static_cast<int>(config.options().hz)) {
+    const auto& options = config_.options();
+    Stats::getInstance().setPort(static_cast<int>(options.port));
+    store_.setLazyFreeExpire(options.lazyfree_lazy_expire);
+    store_.setLazyFreeServerDel(options.lazyfree_lazy_server_del);
+    store_.setLazyFreeUserDel(options.lazyfree_lazy_user_del);
+    applyAofFsync();
+    adjustOpenFilesLimit();
 
-    sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(port);
-    if (bind(server_fd_, (sockaddr*)&addr, sizeof(addr)) < 0) {
-        close(server_fd_);
-        throw std::runtime_error("Bind failed");
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw std::runtime_error("Failed to create epoll instance");
     }
 
-    if (listen(server_fd_, 10) < 0) {
-        close(server_fd_);
-        throw std::runtime_error("Listen failed");
+    try {
+        // data.ptr 指向事件源对象本身，事件分发时不需要再按 fd 查表
+        epoll_event ev;
+        ev.data.ptr = &cron_;
+        ev.events = EPOLLIN;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, cron_.fd(), &ev) < 0) {
+            throw std::runtime_error("Failed to add timerfd to epoll");
+        }
+        if (options.port != 0) {
+            for (const auto& addr : options.bind) {
+                listenTcp(addr, static_cast<int>(options.port));
+            }
+        }
+        if (!options.unixsocket.empty()) {
+            listenUnix(options.unixsocket, static_cast<int>(options.unixsocketperm));
+        }
+        if (listeners_.empty()) {
+            throw std::runtime_error("No listening sockets configured (port 0 and no unixsocket)");
+        }
+        // listeners_ 不再增长后才能取元素地址
+        for (auto& listener : listeners_) {
+            ev.data.ptr = &listener;
+            if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listener.fd, &ev) < 0) {
+                throw std::runtime_error("Failed to add server socket to epoll");
+            }
+        }
+    } catch (...) {
+        // 构造失败时析构函数不会执行，需要在这里释放已创建的 socket
+        for (const auto& listener : listeners_) {
+            close(listener.fd);
+        }
+        if (!options.unixsocket.empty()) {
+            unlink(options.unixsocket.c_str());
+        }
+        close(epoll_fd_);
+        throw;
     }
 
-    epoll_fd_ = epoll_create1(0);
-    if (epoll_fd_ < 0) {
-        close(server_fd_);
-        throw std::runtime_error("Failed to create epoll instance");
+    // listen 的 backlog 会被内核截断到 somaxconn，此时连接风暴下 SYN 依然会被丢弃
+    std::ifstream somaxconn("/proc/sys/net/core/somaxconn");
+    int64_t max_backlog = 0;
+    if (somaxconn >> max_backlog && max_backlog < options.tcp_backlog) {
+        std::cerr << "WARNING: tcp-backlog " << options.tcp_backlog
+                  << " is capped by /proc/sys/net/core/somaxconn (" << max_backlog << ")\n";
     }
 
-    // 将服务器套接字添加到epoll监听
-    epoll_event ev;
-    ev.data.fd = server_fd_;
-    ev.events = EPOLLIN;
-    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, server_fd_, &ev) < 0) {
-        close(epoll_fd_);
-        close(server_fd_);
-        throw std::runtime_error("Failed to add server socket to epoll");
+    // 失效消息可能写给当前事件之外的客户端，与普通响应一样在本轮结束前发送
+    Tracking::getInstance().setOutputHandler([this](Client& client) { queueWrite(client); });
+    config_.setChangeHandler([this](std::string_view name) { onConfigChange(name); });
+    scheduleJobs();
+}
+
+void Server::scheduleJobs() {
+    using std::chrono::milliseconds;
+    using std::chrono::microseconds;
+
+    // 主动过期：每 100ms 最多占用 25ms，与 Redis 的慢速过期周期相当
+    cron_.addJob("expire-cycle", milliseconds(100), milliseconds(25),
+                 [this](Cron::Clock::time_point deadline) { store_.activeExpireCycle(deadline); });
+    cron_.addJob("aof-fsync", milliseconds(1000), milliseconds(1), [this](Cron::Clock::time_point) {
+        if (store_.aofFsync() == Store::AofFsync::EverySec) {
+            store_.fsyncAof();
+        }
+    });
+    cron_.addJob("stats-sample", milliseconds(100), microseconds(100),
+                 [](Cron::Clock::time_point) { Stats::getInstance().sampleInstantaneous(); });
+    cron_.addJob("client-timeout", milliseconds(1000), milliseconds(1),
+                 [this](Cron::Clock::time_point deadline) { closeIdleClients(deadline); });
+    cron_.addJob("client-buffers", milliseconds(1000), milliseconds(1),
+                 [this](Cron::Clock::time_point deadline) { shrinkClientBuffers(deadline); });
+    // 大键分析进行中时每个时间片都推进一步
+    cron_.addJob("bigkeys", milliseconds(0), milliseconds(10),
+                 [this](Cron::Clock::time_point deadline) {
+                     BigKeys::getInstance().step(store_, deadline);
+                 });
+    // 分层存储：写命令只同步换出少量 value，其余超出内存上限的部分在这里追上
+    if (store_.tiered()) {
+        cron_.addJob("tiered-evict", milliseconds(0), milliseconds(5),
+                     [this](Cron::Clock::time_point deadline) {
+                         store_.evictColdValues(deadline);
+                     });
+        cron_.addJob("tiered-compact", milliseconds(100), milliseconds(5),
+                     [this](Cron::Clock::time_point deadline) {
+                         store_.compactValueLog(deadline);
+                     });
+    }
+}
+
+template <typename F>
+void Server::forEachClient(size_t& cursor, Cron::Clock::time_point deadline, F&& fn) {
+    size_t slots = clients_.size();
+    for (size_t visited = 1; visited <= slots; ++visited) {
+        if (cursor >= clients_.size()) {
+            cursor = 0;
+        }
+        Client* client = clients_[cursor++].get();
+        if (client && client->fd >= 0) {
+            fn(*client);
+        }
+        if (visited % 64 == 0 && Cron::Clock::now() >= deadline) {
+            break;  // 剩余的连接留到下一次
+        }
     }
 }
 
+void Server::closeIdleClients(Cron::Clock::time_point deadline) {
+    int64_t timeout = config_.options().timeout;
+    if (timeout <= 0) {
+        return;
+    }
+    auto now = Cron::Clock::now();
+    forEachClient(timeout_cursor_, deadline, [&](Client& client) {
+        // 还有未发送完的响应说明对端只是读得慢，不算空闲
+        if (client.response.empty() &&
+            now - client.last_interaction >= std::chrono::seconds(timeout)) {
+            closeClient(client);
+        }
+    });
+}
+
+void Server::shrinkClientBuffers(Cron::Clock::time_point deadline) {
+    forEachClient(shrink_cursor_, deadline, [](Client& client) {
+        if (client.buffer.capacity() > QUERYBUF_SHRINK_THRESHOLD &&
+            client.buffer.size() < client.buffer.capacity() / 2) {
+            client.buffer.shrink(QUERYBUF_MIN_CAPACITY);
+        }
+        if (client.response.empty() && client.response.capacity() > REPLYBUF_SHRINK_THRESHOLD) {
+            client.response.clear();
+        }
+    });
+}
+
 Server::~Server() {
+    config_.setChangeHandler(nullptr);
+    Tracking::getInstance().setOutputHandler(nullptr);
     close(epoll_fd_);
-    close(server_fd_);
+    for (const auto& listener : listeners_) {
+        close(listener.fd);
+    }
+    if (!config_.options().unixsocket.empty()) {
+        unlink(config_.options().unixsocket.c_str());
+    }
     // 关闭所有客户端连接
-    for (auto& [fd, _] : clients_) {
+    for (auto& client : clients_) {
+        if (client && client->fd >= 0) {
+            Tracking::getInstance().removeClient(*client);
+            close(client->fd);
+        }
+    }
+}
+
+void Server::listenTcp(const std::string& addr, int port) {
+    sockaddr_storage storage{};
+    socklen_t len;
+    auto* v4 = reinterpret_cast<sockaddr_in*>(&storage);
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(&storage);
+    if (inet_pton(AF_INET, addr.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(port);
+        len = sizeof(*v4);
+    } else if (inet_pton(AF_INET6, addr.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(port);
+        len = sizeof(*v6);
+    } else {
+        throw std::runtime_error("Invalid bind address: " + addr);
+    }
+
+    int fd = socket(storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create socket");
+    }
+
+    int opt = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
         close(fd);
+        throw std::runtime_error("Failed to set socket options");
+    }
+    // 同时绑定 0.0.0.0 与 :: 时，IPv6 socket 不能再占用 IPv4 地址
+    if (storage.ss_family == AF_INET6 &&
+        setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &opt, sizeof(opt)) < 0) {
+        close(fd);
+        throw std::runtime_error("Failed to set IPV6_V6ONLY");
+    }
+    // 接收缓冲区需要在 listen 前设置，握手时才能协商出相应的窗口扩大因子；accept 得到的连接会继承
+    int rcvbuf = static_cast<int>(config_.options().so_rcvbuf);
+    if (rcvbuf > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&storage), len) < 0) {
+        close(fd);
+        throw std::runtime_error("Bind failed: " + addr + ":" + std::to_string(port));
+    }
+
+    if (listen(fd, static_cast<int>(config_.options().tcp_backlog)) < 0) {
+        close(fd);
+        throw std::runtime_error("Listen failed");
     }
+    listeners_.push_back({fd, false});
 }
 
-void Server::run() {
-    epoll_event events[MAX_EVENTS];
-    while (true) {
-        // 采用带超时时间的 epoll_wait，定期检查过期键，防止长时间阻塞
-        int nfds = epoll_wait(epoll_fd_, events, MAX_EVENTS, EPOLL_TIMEOUT_MS);
-        for (int i = 0; i < nfds; ++i) {
-            int fd = events[i].data.fd;
-            if (fd == server_fd_) {
-                handleNewConnection();  // 处理新连接
-            } else {
-                handleClientEvent(fd, events[i].events);  // 处理客户端事件
-            }
+void Server::listenUnix(const std::string& path, int perm) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Unix socket path too long: " + path);
+    }
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, path.size());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create unix socket");
+    }
+
+    // 上次未正常退出时残留的 socket 文件会导致 bind 失败
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        throw std::runtime_error("Bind failed: " + path);
+    }
+    if (perm != 0 && chmod(path.c_str(), static_cast<mode_t>(perm)) < 0) {
+        close(fd);
+        throw std::runtime_error("Failed to chmod unix socket: " + path);
+    }
+    if (listen(fd, static_cast<int>(config_.options().tcp_backlog)) < 0) {
+        close(fd);
+        throw std::runtime_error("Listen failed: " + path);
+    }
+    listeners_.push_back({fd, true});
+}
+
+const Server::Listener* Server::findListener(const void* ptr) const {
+    for (const auto& listener : listeners_) {
+        if (&listener == ptr) {
+            return &listener;
         }
+    }
+    return nullptr;
+}
 
-        // 定期清理过期键
-        auto now = std::chrono::system_clock::now();
-        if (now - last_cleanup_ >= CLEANUP_INTERVAL) {
-            store_.cleanupExpiredKeys();
-            last_cleanup_ = now;
+void Server::configureTcpClient(int fd) {
+    const auto& options = config_.options();
+    auto setOption = [fd](int level, int name, int value, const char* what) {
+        if (setsockopt(fd, level, name, &value, sizeof(value)) < 0) {
+            std::cerr << "Failed to set " << what << "\n";
         }
+    };
+    // 关闭 Nagle 算法，小响应不必等待 ACK 或凑满一个 MSS
+    if (options.tcp_nodelay) {
+        setOption(IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+    }
+    // 空闲 tcp_keepalive 秒后开始探测，约 2 倍该时间后判定对端失联
+    if (options.tcp_keepalive > 0) {
+        int idle = static_cast<int>(options.tcp_keepalive);
+        setOption(SOL_SOCKET, SO_KEEPALIVE, 1, "SO_KEEPALIVE");
+        setOption(IPPROTO_TCP, TCP_KEEPIDLE, idle, "TCP_KEEPIDLE");
+        setOption(IPPROTO_TCP, TCP_KEEPINTVL, std::max(idle / 3, 1), "TCP_KEEPINTVL");
+        setOption(IPPROTO_TCP, TCP_KEEPCNT, 3, "TCP_KEEPCNT");
+    }
+    if (options.so_sndbuf > 0) {
+        setOption(SOL_SOCKET, SO_SNDBUF, static_cast<int>(options.so_sndbuf), "SO_SNDBUF");
+    }
+    if (options.so_rcvbuf > 0) {
+        setOption(SOL_SOCKET, SO_RCVBUF, static_cast<int>(options.so_rcvbuf), "SO_RCVBUF");
     }
 }
 
-void Server::setNonBlocking(int fd) {
-    int flags = fcntl(fd, F_GETFL, 0);
-    if (flags == -1) {
-        throw std::runtime_error("Failed to get socket flags");
+void Server::adjustOpenFilesLimit() {
+    auto needed = static_cast<rlim_t>(config_.options().maxclients + RESERVED_FDS);
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) < 0 || limit.rlim_cur >= needed) {
+        return;
     }
-    if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
-        throw std::runtime_error("Failed to set non-blocking");
+    // 软限制最多提高到硬限制，更高的值需要 root 权限
+    rlim_t old_limit = limit.rlim_cur;
+    limit.rlim_cur = std::min(needed, limit.rlim_max);
+    if (limit.rlim_cur > old_limit && setrlimit(RLIMIT_NOFILE, &limit) < 0) {
+        limit.rlim_cur = old_limit;
+    }
+    if (limit.rlim_cur < needed) {
+        std::cerr << "WARNING: maxclients " << config_.options().maxclients
+                  << " requires an open files limit of " << needed << ", current limit is "
+                  << limit.rlim_cur << "\n";
+    }
+}
+
+void Server::applyAofFsync() {
+    const auto& policy = config_.options().appendfsync;
+    if (policy == "always") {
+        store_.setAofFsync(Store::AofFsync::Always);
+    } else if (policy == "no") {
+        store_.setAofFsync(Store::AofFsync::No);
+    } else {
+        store_.setAofFsync(Store::AofFsync::EverySec);
+    }
+}
+
+void Server::onConfigChange(std::string_view name) {
+    const auto& options = config_.options();
+    if (name == "tcp-backlog") {
+        // Linux 上对已监听的 socket 再次调用 listen 会更新 backlog
+        for (const auto& listener : listeners_) {
+            listen(listener.fd, static_cast<int>(options.tcp_backlog));
+        }
+    } else if (name == "maxclients") {
+        adjustOpenFilesLimit();
+    } else if (name == "hz") {
+        cron_.setHz(static_cast<int>(options.hz));
+    } else if (name == "appendfsync") {
+        applyAofFsync();
+    } else if (name == "lazyfree-lazy-expire") {
+        store_.setLazyFreeExpire(options.lazyfree_lazy_expire);
+    } else if (name == "lazyfree-lazy-server-del") {
+        store_.setLazyFreeServerDel(options.lazyfree_lazy_server_del);
+    } else if (name == "lazyfree-lazy-user-del") {
+        store_.setLazyFreeUserDel(options.lazyfree_lazy_user_del);
+    } else if (name == "value-compression" || name == "value-compression-threshold") {
+        store_.setCompressThreshold(compressThreshold(options));
+    } else if (name == "tiered-max-memory") {
+        store_.setTieredMaxMemory(static_cast<size_t>(options.tiered_max_memory));
+    } else if (name == "tiered-min-value-size") {
+        store_.setTieredMinValueSize(static_cast<size_t>(options.tiered_min_value_size));
+    } else if (name == "tiered-compact-garbage-ratio") {
+        store_.setTieredCompactGarbagePercent(
+            static_cast<int>(options.tiered_compact_garbage_ratio));
     }
 }
 
-void Server::handleNewConnection() {
+void Server::run() {
+    epoll_event events[MAX_EVENTS];
     while (true) {
-        int client_fd = accept(server_fd_, nullptr, nullptr);
+        // 后台任务由 timerfd 驱动，空闲时可以无限期阻塞；还有未处理完的连接时只轮询一次
+        int timeout = pending_reads_.empty() && pending_writes_.empty() ? -1 : 0;
+        int nfds = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout);
+        ++loop_iteration_;
+        for (int i = 0; i < nfds; ++i) {
+            void* ptr = events[i].data.ptr;
+            if (ptr == &cron_) {
+                cron_.onTimer();  // 执行到期的定时任务
+            } else if (const Listener* listener = findListener(ptr)) {
+                handleNewConnection(*listener);  // 处理新连接
+            } else {
+                // 本轮中先被定时任务或其他事件关闭的连接，剩余事件直接丢弃
+                Client& client = *static_cast<Client*>(ptr);
+                if (client.fd >= 0 && client.closed_iteration != loop_iteration_) {
+                    handleClientEvent(client, events[i].events);  // 处理客户端事件
+                }
+            }
+        }
+        handlePendingIo();
+    }
+}
+
+void Server::handleNewConnection(const Listener& listener) {
+    auto& stats = Stats::getInstance();
+    // 单次最多接受 MAX_ACCEPTS_PER_CALL 个连接，剩余的由水平触发的监听 socket 下一轮继续报告
+    for (int i = 0; i < MAX_ACCEPTS_PER_CALL; ++i) {
+        int client_fd = accept4(listener.fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (client_fd < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                break;  // 没有更多待处理连接
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "Accept failed: " << strerror(errno) << "\n";
             }
-            std::cerr << "Accept failed\n";
             return;
         }
 
-        setNonBlocking(client_fd);
+        if (stats.connectedClients() >= static_cast<uint64_t>(config_.options().maxclients)) {
+            // 尽力把原因告诉客户端，发送失败也直接关闭
+            static constexpr std::string_view error = "-ERR max number of clients reached\r\n";
+            send(client_fd, error.data(), error.size(), MSG_NOSIGNAL);
+            close(client_fd);
+            stats.onRejectedConnection();
+            continue;
+        }
+        if (!listener.unix_socket) {
+            configureTcpClient(client_fd);
+        }
 
+        // 边缘触发模式下一次注册读写事件，之后不再需要 EPOLL_CTL_MOD
+        Client& client = acquireClient(client_fd);
         epoll_event ev;
-        ev.events = EPOLLIN | EPOLLHUP | EPOLLERR;  // 监听可读、挂起和错误事件
-        ev.data.fd = client_fd;
-
-        // 将客户端套接字添加到epoll
+        ev.events = edge_triggered_ ? (EPOLLIN | EPOLLOUT | EPOLLET) : EPOLLIN;
+        ev.data.ptr = &client;
         if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
             close(client_fd);
+            client.reset();
             std::cerr << "Failed to add client to epoll\n";
             return;
         }
-
-        // 将新客户端添加到客户端映射表
-        clients_.emplace(client_fd, Client{});
+        Tracking::getInstance().addClient(client);
+        stats.onConnect();
     }
 }
 
-void Server::handleClientEvent(int client_fd, uint32_t events) {
-    auto& client = clients_.at(client_fd);
+Client& Server::acquireClient(int fd) {
+    // fd 总是取最小的可用值，连接表的大小与最大并发连接数相当
+    if (static_cast<size_t>(fd) >= clients_.size()) {
+        clients_.resize(static_cast<size_t>(fd) + 1);
+    }
+    auto& slot = clients_[fd];
+    if (!slot) {
+        slot = std::make_unique<Client>();
+    }
+    slot->fd = fd;
+    slot->id = next_client_id_++;
+    slot->last_interaction = Cron::Clock::now();
+    return *slot;
+}
 
+void Server::handleClientEvent(Client& client, uint32_t events) {
     // 处理连接挂起或错误事件
     if (events & (EPOLLHUP | EPOLLERR)) {
-        closeClient(client_fd);
+        closeClient(client);
         return;
     }
 
-    // 处理可读事件（客户端发送数据）
-    if (events & EPOLLIN) {
-        char buffer[1024];  // 接收缓冲区
-        while (true) {
-            ssize_t bytes_read = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
-            if (bytes_read < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    break;  // 没有更多数据可读
-                }
-                closeClient(client_fd);
-                return;
-            }
-            if (bytes_read == 0) {  // 客户端关闭连接
-                closeClient(client_fd);
-                return;
+    // 协议错误后不再读取，等待错误回复发送完毕后关闭
+    if ((events & EPOLLIN) && !client.close_after_reply) {
+        IoResult result = readFromClient(client);
+        if (result == IoResult::Closed) {
+            return;
+        }
+        if (result == IoResult::Capped && edge_triggered_) {
+            queueRead(client);
+        }
+    }
+    if (!client.response.empty()) {
+        queueWrite(client);
+    }
+}
+
+Server::IoResult Server::readFromClient(Client& client) {
+    if (client.waiting_for_disk) {
+        // 上次停在等待读盘的命令上，先重试读缓冲区中剩下的命令
+        processInput(client);
+        if (client.close_after_reply) {
+            return IoResult::Drained;
+        }
+    }
+
+    char buffer[READ_CHUNK];  // 接收缓冲区
+    size_t total = 0;
+    // 单次事件读取量有上限，一个持续发送大量数据的连接不会饿死其他连接
+    while (total < MAX_READ_PER_EVENT) {
+        ssize_t bytes_read = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (bytes_read < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return IoResult::Drained;  // 没有更多数据可读
             }
-            // buffer[bytes_read] = '\0';
-            // client.buffer += buffer;
-            client.buffer.write(buffer, bytes_read);
-
-            // 处理 RESP 信息
-            size_t consumed = 0;
-            while (consumed < client.buffer.size()) {
-                size_t bytes_consumed = 0;
-                // std::string response = Command::process(client.buffer, bytes_consumed, store_,
-                // client);
-                std::string response =
-                    Command::process(client.buffer.peek(consumed, client.buffer.size() - consumed),
-                                     bytes_consumed, store_, client);
-                if (bytes_consumed == 0) {
-                    break;
-                }
-                // client.buffer.erase(0, bytes_consumed);
-                client.response += response;
-                consumed += bytes_consumed;
+            if (errno == EINTR) {
+                continue;
             }
-            client.buffer.consume(consumed);
+            closeClient(client);
+            return IoResult::Closed;
+        }
+        if (bytes_read == 0) {  // 客户端关闭连接
+            closeClient(client);
+            return IoResult::Closed;
+        }
+        total += static_cast<size_t>(bytes_read);
+        client.buffer.write(buffer, bytes_read);
+        client.last_interaction = Cron::Clock::now();
+        Stats::getInstance().onRead(static_cast<size_t>(bytes_read));
+
+        if (store_.hasSpilledValues()) {
+            prefetchColdValues(client);
+        }
+        processInput(client);
+        if (client.close_after_reply) {
+            return IoResult::Drained;
         }
     }
+    return IoResult::Capped;
+}
 
-    // 处理可写事件（发送响应给客户端）
-    if (!client.response.empty() && !client.has_pending_write) {
-        // 添加EPOLLOUT事件监听
-        epoll_event ev;
-        ev.events = EPOLLIN | EPOLLOUT | EPOLLHUP | EPOLLERR;
-        ev.data.fd = client_fd;
-        if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, client_fd, &ev) < 0) {
-            closeClient(client_fd);
+void Server::processInput(Client& client) {
+    size_t consumed = 0;
+    while (consumed < client.buffer.size()) {
+        size_t bytes_consumed = 0;
+        std::string response =
+            Command::process(client.buffer.peek(consumed, client.buffer.size() - consumed),
+                             bytes_consumed, store_, client);
+        if (client.close_after_reply) {
+            // 剩余的输入无法再解析，全部丢弃
+            client.response.append(response);
+            client.buffer.consume(client.buffer.size());
             return;
         }
-        client.has_pending_write = true;  // 添加EPOLLOUT事件监听
+        if (bytes_consumed == 0) {
+            break;
+        }
+        client.response.append(response);
+        if (!client.pending_pushes.empty()) {
+            client.response.append(client.pending_pushes);
+            client.pending_pushes.clear();
+        }
+        consumed += bytes_consumed;
+    }
+    client.buffer.consume(consumed);
+    if (client.waiting_for_disk) {
+        // 预读已经发起，下一轮事件循环再试，期间继续服务其他连接
+        queueRead(client);
+    }
+}
+
+void Server::prefetchColdValues(Client& client) {
+    // 只解析不执行；预读在内核中并行进行，执行到后面的 GET 时数据多半已在 page cache 中
+    std::vector<std::string_view> tokens;
+    size_t offset = 0;
+    while (offset < client.buffer.size()) {
+        size_t consumed = 0;
+        tokens.clear();
+        if (Command::parseResp(client.buffer.peek(offset, client.buffer.size() - offset),
+                               consumed, tokens) != Command::ParseResult::Ok) {
+            break;
+        }
+        if (tokens.size() == 2 && tokens[0] == "GET") {
+            store_.prefetch(tokens[1]);
+        }
+        offset += consumed;
     }
+}
 
-    // 发送响应数据
-    if (events & EPOLLOUT && !client.response.empty()) {
-        ssize_t bytes_sent = send(client_fd, client.response.c_str(), client.response.size(), 0);
+Server::IoResult Server::writeToClient(Client& client) {
+    size_t total = 0;
+    // 只为大响应计时，每个响应从第一次发送到全部发完只记录一个样本
+    if (!client.large_reply && client.response.size() >= LARGE_REPLY_BYTES) {
+        client.large_reply = true;
+        client.large_reply_time = {};
+    }
+    while (!client.response.empty()) {
+        if (total >= MAX_WRITE_PER_EVENT) {
+            return IoResult::Capped;
+        }
+        // 拷贝的小响应与引用的大 value 一起交给内核，sendmsg 可以使用 MSG_NOSIGNAL 而 writev 不能
+        iovec iov[IOV_PER_WRITE];
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = static_cast<size_t>(client.response.prepare(iov, IOV_PER_WRITE));
+        auto start = client.large_reply ? Stats::Clock::now() : Stats::Clock::time_point{};
+        ssize_t bytes_sent = sendmsg(client.fd, &msg, MSG_NOSIGNAL);
+        if (client.large_reply) {
+            client.large_reply_time += Stats::Clock::now() - start;
+        }
         if (bytes_sent < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                return;  // 稍后重试
+                return IoResult::Drained;  // 发送缓冲区已满，稍后重试
             }
-            closeClient(client_fd);
-            return;
+            if (errno == EINTR) {
+                continue;
+            }
+            closeClient(client);
+            return IoResult::Closed;
         }
 
         // 移除已发送的数据
-        client.response.erase(0, bytes_sent);
-        if (client.response.empty()) {
-            // 如果所有数据都已发送，取消EPOLLOUT监听
-            epoll_event ev;
-            ev.events = EPOLLIN | EPOLLHUP | EPOLLERR;
-            ev.data.fd = client_fd;
-            if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, client_fd, &ev) < 0) {
-                closeClient(client_fd);
-                return;
+        Stats::getInstance().onWrite(static_cast<size_t>(bytes_sent));
+        client.response.consume(static_cast<size_t>(bytes_sent));
+        total += static_cast<size_t>(bytes_sent);
+    }
+    if (client.large_reply) {
+        client.large_reply = false;
+        auto elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(client.large_reply_time);
+        Stats::getInstance().recordLatency("large-reply", static_cast<uint64_t>(elapsed.count()));
+    }
+    return IoResult::Drained;
+}
+
+void Server::queueRead(Client& client) {
+    if (!client.read_queued) {
+        client.read_queued = true;
+        pending_reads_.push_back(&client);
+    }
+}
+
+void Server::queueWrite(Client& client) {
+    if (!client.write_queued) {
+        client.write_queued = true;
+        pending_writes_.push_back(&client);
+    }
+}
+
+void Server::handlePendingIo() {
+    // 入队后关闭的连接在 reset 时已清除入队标记；处理中再次入队的连接追加在队尾，留到下一轮
+    size_t count = pending_reads_.size();
+    for (size_t i = 0; i < count; ++i) {
+        Client* client = pending_reads_[i];
+        if (client->read_queued) {
+            client->read_queued = false;
+            handleClientEvent(*client, EPOLLIN);
+        }
+    }
+    pending_reads_.erase(pending_reads_.begin(),
+                         pending_reads_.begin() + static_cast<ptrdiff_t>(count));
+
+    // 一轮事件产生的响应集中发送：多数响应一次 send 即可发完，不需要注册 EPOLLOUT
+    count = pending_writes_.size();
+    for (size_t i = 0; i < count; ++i) {
+        Client* client = pending_writes_[i];
+        if (!client->write_queued) {
+            continue;
+        }
+        client->write_queued = false;
+        IoResult result = writeToClient(*client);
+        if (result == IoResult::Closed) {
+            continue;
+        }
+        if (client->close_after_reply && client->response.empty()) {
+            closeClient(*client);
+            continue;
+        }
+        if (edge_triggered_) {
+            // 因 EAGAIN 停下时，发送缓冲区腾出空间后会收到 EPOLLOUT
+            if (result == IoResult::Capped) {
+                queueWrite(*client);
             }
-            client.has_pending_write = false;
+        } else if (!setWritable(*client, !client->response.empty())) {
+            closeClient(*client);
         }
     }
+    pending_writes_.erase(pending_writes_.begin(),
+                          pending_writes_.begin() + static_cast<ptrdiff_t>(count));
 }
 
-void Server::closeClient(int client_fd) {
-    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client_fd, nullptr);
-    close(client_fd);
+bool Server::setWritable(Client& client, bool writable) {
+    if (client.has_pending_write == writable) {
+        return true;
+    }
+    epoll_event ev;
+    ev.events = writable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.ptr = &client;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, client.fd, &ev) < 0) {
+        return false;
+    }
+    client.has_pending_write = writable;
+    return true;
+}
 
-    // 从客户端映射表中移除
-    clients_.erase(client_fd);
+void Server::closeClient(Client& client) {
+    if (client.fd < 0) {
+        return;  // 已经关闭，重复关闭会多减一次连接数
+    }
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client.fd, nullptr);
+    close(client.fd);
+    Tracking::getInstance().removeClient(client);
+    Stats::getInstance().onDisconnect();
+    // 保留对象与缓冲区供同一 fd 的下一个连接复用，Tracking 中记录的指针也因此不会悬空
+    client.reset();
+    client.closed_iteration = loop_iteration_;
 }
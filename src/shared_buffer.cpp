@@ -0,0 +1,32 @@
+#include "shared_buffer.hpp"
+
+#include <cstring>
+#include <new>
+
+SharedBuffer SharedBuffer::copyOf(std::string_view data) {
+    SharedBuffer buffer = allocate(data.size());
+    if (!data.empty()) {
+        std::memcpy(buffer.writableData(), data.data(), data.size());
+    }
+    return buffer;
+}
+
+SharedBuffer SharedBuffer::allocate(size_t size) {
+    SharedBuffer buffer;
+    if (size == 0) {
+        return buffer;
+    }
+    void* memory = ::operator new(sizeof(Header) + size);
+    buffer.header_ = new (memory) Header{{1}, size};
+    return buffer;
+}
+
+void SharedBuffer::release() {
+    // 与 std::shared_ptr 相同：递减用 release，最后一个引用用 acquire 看到其他线程的写入
+    if (header_ && header_->refs.fetch_sub(1, std::memory_order_release) == 1) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        header_->~Header();
+        ::operator delete(header_);
+    }
+    header_ = nullptr;
+}
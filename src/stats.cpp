@@ -0,0 +1,161 @@
+#include "stats.hpp"
+
+#include <algorithm>
+
+#include "command.hpp"
+
+namespace {
+    int64_t unixNow() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+}
+
+Stats& Stats::getInstance() {
+    static Stats instance;
+    return instance;
+}
+
+Stats::Stats() : start_time_(std::chrono::system_clock::now()) {}
+
+int64_t Stats::uptimeSeconds() const {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() -
+                                                            start_time_)
+        .count();
+}
+
+void Stats::recordCommand(const std::vector<std::string_view>& tokens, uint64_t usec) {
+    ++total_commands_;
+
+    auto it = command_stats_.find(tokens[0]);
+    if (it == command_stats_.end()) {
+        // 只为已注册的命令建立条目，避免任意未知命令名让表无限增长
+        if (!CommandFactory::getInstance().hasCommand(tokens[0])) {
+            return;
+        }
+        it = command_stats_.emplace(std::string(tokens[0]), CommandStat{}).first;
+    }
+    auto& stat = it->second;
+    ++stat.calls;
+    stat.usec += usec;
+    stat.latency.record(usec);
+
+    if (slowlog_threshold_us_ >= 0 && usec >= static_cast<uint64_t>(slowlog_threshold_us_)) {
+        SlowlogEntry entry{slowlog_next_id_++, unixNow(), usec, {}};
+        size_t argc = std::min(tokens.size(), SLOWLOG_MAX_ARGC);
+        entry.args.reserve(argc);
+        for (size_t i = 0; i < argc; ++i) {
+            if (i + 1 == SLOWLOG_MAX_ARGC && tokens.size() > SLOWLOG_MAX_ARGC) {
+                entry.args.push_back("... (" + std::to_string(tokens.size() - i) +
+                                     " more arguments)");
+                break;
+            }
+            if (tokens[i].size() > SLOWLOG_MAX_ARGLEN) {
+                entry.args.push_back(std::string(tokens[i].substr(0, SLOWLOG_MAX_ARGLEN)) +
+                                     "... (" +
+                                     std::to_string(tokens[i].size() - SLOWLOG_MAX_ARGLEN) +
+                                     " more bytes)");
+            } else {
+                entry.args.emplace_back(tokens[i]);
+            }
+        }
+        slowlog_.push_front(std::move(entry));
+        while (slowlog_.size() > slowlog_max_len_) {
+            slowlog_.pop_back();
+        }
+    }
+
+    recordLatency("command", usec / 1000);
+}
+
+void Stats::recordLatency(std::string_view event, uint64_t msec) {
+    if (latency_threshold_ms_ == 0 || msec < latency_threshold_ms_) {
+        return;
+    }
+    auto it = latency_events_.find(event);
+    if (it == latency_events_.end()) {
+        it = latency_events_.emplace(std::string(event), LatencyEvent{}).first;
+    }
+    auto& ev = it->second;
+    int64_t now = unixNow();
+    ev.latest = {now, msec};
+    ev.max = std::max(ev.max, msec);
+
+    // 同一秒内的多次样本合并为最大值
+    if (!ev.history.empty() && ev.history.back().timestamp == now) {
+        ev.history.back().msec = std::max(ev.history.back().msec, msec);
+        return;
+    }
+    ev.history.push_back({now, msec});
+    if (ev.history.size() > LATENCY_HISTORY_LEN) {
+        ev.history.pop_front();
+    }
+}
+
+void Stats::recordCronJob(std::string_view job, uint64_t usec, bool over_budget) {
+    auto it = cron_stats_.find(job);
+    if (it == cron_stats_.end()) {
+        it = cron_stats_.emplace(std::string(job), CronStat{}).first;
+    }
+    auto& stat = it->second;
+    ++stat.runs;
+    stat.usec += usec;
+    stat.max_usec = std::max(stat.max_usec, usec);
+    if (over_budget) {
+        ++stat.over_budget;
+    }
+}
+
+void Stats::sampleInstantaneous() {
+    auto now = Clock::now();
+    ops_.sample(total_commands_, now);
+    input_.sample(net_input_bytes_, now);
+    output_.sample(net_output_bytes_, now);
+}
+
+void Stats::RateSampler::sample(uint64_t value, Clock::time_point now) {
+    if (last_time != Clock::time_point{}) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time).count();
+        // CONFIG RESETSTAT 会把计数器清零，此时本次增量按 0 计
+        uint64_t delta = value >= last_value ? value - last_value : 0;
+        samples[index] = ms > 0 ? delta * 1000 / static_cast<uint64_t>(ms) : 0;
+        index = (index + 1) % SAMPLES;
+    }
+    last_value = value;
+    last_time = now;
+}
+
+uint64_t Stats::RateSampler::average() const {
+    uint64_t sum = 0;
+    for (uint64_t v : samples) {
+        sum += v;
+    }
+    return sum / SAMPLES;
+}
+
+void Stats::resetCommandStats() {
+    command_stats_.clear();
+    total_commands_ = 0;
+}
+
+void Stats::setSlowlogMaxLen(size_t len) {
+    slowlog_max_len_ = len;
+    while (slowlog_.size() > slowlog_max_len_) {
+        slowlog_.pop_back();
+    }
+}
+
+size_t Stats::resetLatency(std::string_view event) {
+    if (event.empty()) {
+        size_t count = latency_events_.size();
+        latency_events_.clear();
+        return count;
+    }
+    auto it = latency_events_.find(event);
+    if (it == latency_events_.end()) {
+        return 0;
+    }
+    latency_events_.erase(it);
+    return 1;
+}
@@ -1,19 +1,36 @@
 #include "store.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <iterator>
 
 #include "command.hpp"
-Store::Store(const std::string& aof_file) : aof_file_(aof_file) {
+#include "glob.hpp"
+#include "stats.hpp"
+#include "tracking.hpp"
+
+Store::Store(const std::string& aof_file, size_t compress_threshold, TieredOptions tiered)
+    : aof_file_(aof_file), compress_threshold_(compress_threshold), tiered_(std::move(tiered)) {
+    // 在重放 AOF 之前创建，数据集超过内存上限时重放过程中即开始换出
+    if (!tiered_.path.empty()) {
+        log_ = std::make_unique<ValueLog>(tiered_.path);
+    }
     if (std::filesystem::exists(aof_file)) {
         replayAof();
     }
 
-    aof_.open(aof_file, std::ios::app | std::ios::binary);
-    if (!aof_.is_open()) {
+    // 直接使用文件描述符，fsync 需要它
+    aof_fd_ = open(aof_file.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (aof_fd_ < 0) {
         throw std::runtime_error("Failed to open AOF file: " + aof_file);
     }
+    aof_size_ = std::filesystem::file_size(aof_file);
+    aof_synced_size_ = aof_size_;
 
     // std::cout << "print persistent data...\n";
     // for (auto x : data_) {
@@ -23,69 +40,448 @@ Store::Store(const std::string& aof_file) : aof_file_(aof_file) {
 }
 
 Store::~Store() {
-    if (aof_.is_open()) {
-        aof_.close();
+    if (aof_fd_ >= 0) {
+        if (aof_fsync_ != AofFsync::No) {
+            fsyncAof();
+        }
+        close(aof_fd_);
     }
 }
 
-void Store::set(const std::string& key, const std::string& value) {
-    data_[key] = value;
+void Store::set(const std::string& key, std::string_view value) {
+    Value stored = Value::make(value, compress_threshold_);
+    auto [entry, inserted] = data_.insert(key);
+    if (!inserted) {
+        removeValueStats(key, entry->value);
+        // 覆盖大 value 时先把旧值移交后台线程，避免在事件循环中析构
+        if (lazyfree_lazy_server_del_ && entry->value.storedSize() >= LAZYFREE_THRESHOLD) {
+            lazy_free_.free(std::move(entry->value));
+        }
+    }
+    addValueStats(stored);
+    entry->value = std::move(stored);
+    Tracking::getInstance().invalidate(key);
 
-    // Log SET command in RESP format
-    std::vector<std::string_view> command = {"SET", key, value};
-    logCommand(command);
+    // 已压缩的 value 以压缩形式写入 AOF，重放时直接接管，不需要再次压缩
+    const Value& saved = entry->value;
+    if (saved.compressed()) {
+        std::string raw_size = std::to_string(saved.size());
+        logCommand({"SETLZ", key, raw_size, saved.data()});
+    } else {
+        // Log SET command in RESP format
+        std::vector<std::string_view> command = {"SET", key, value};
+        logCommand(command);
+    }
+    if (log_ && resident_value_bytes_ > tiered_.max_memory) {
+        evictValues(EVICT_BUCKETS_PER_WRITE, std::chrono::steady_clock::time_point::max());
+    }
 }
 
-std::string Store::get(const std::string& key) const {
-    auto it = expirations_.find(key);
-    if (it != expirations_.end()) {
-        if (std::chrono::system_clock::now() >= it->second) {
-            return "";  // Key has expired
+bool Store::setCompressed(const std::string& key, size_t raw_size, std::string_view data) {
+    Value stored;
+    if (!Value::fromCompressed(data, raw_size, stored)) {
+        return false;
+    }
+    auto [entry, inserted] = data_.insert(key);
+    if (!inserted) {
+        removeValueStats(key, entry->value);
+        if (lazyfree_lazy_server_del_ && entry->value.storedSize() >= LAZYFREE_THRESHOLD) {
+            lazy_free_.free(std::move(entry->value));
         }
     }
-    auto data_it = data_.find(key);
-    if (data_it != data_.end()) {
-        return data_it->second;
+    addValueStats(stored);
+    entry->value = std::move(stored);
+    Tracking::getInstance().invalidate(key);
+
+    std::string size = std::to_string(raw_size);
+    logCommand({"SETLZ", key, size, entry->value.data()});
+    if (log_ && resident_value_bytes_ > tiered_.max_memory) {
+        evictValues(EVICT_BUCKETS_PER_WRITE, std::chrono::steady_clock::time_point::max());
     }
-    return "";  // Return empty string for missing keys
+    return true;
+}
+
+void Store::addValueStats(const Value& value) {
+    if (value.compressed()) {
+        ++compressed_values_;
+        compressed_raw_bytes_ += value.size();
+        compressed_stored_bytes_ += value.storedSize();
+    }
+    resident_value_bytes_ += value.storedSize();
+}
+
+void Store::removeValueStats(const std::string& key, const Value& value) {
+    if (value.compressed()) {
+        --compressed_values_;
+        compressed_raw_bytes_ -= value.size();
+        compressed_stored_bytes_ -= value.storedSize();
+    }
+    if (value.resident()) {
+        resident_value_bytes_ -= value.storedSize();
+    } else {
+        --spilled_values_;
+    }
+    if (log_ && value.location() != Value::NO_LOCATION) {
+        log_->release(value.location(), key.size(), value.storedSize());
+    }
+}
+
+std::string Store::get(const std::string& key) {
+    Value value;
+    if (getValue(key, value) != GetResult::Found) {
+        return "";  // Return empty string for missing or expired keys
+    }
+    return value.str();
+}
+
+Store::GetResult Store::getValue(const std::string& key, Value& value) {
+    Value* found = data_.find(key);
+    if (found == nullptr || isExpired(key)) {
+        ++keyspace_misses_;
+        return GetResult::Missing;
+    }
+    if (!found->resident()) {
+        std::string_view data;
+        if (!log_->read(found->location(), found->storedSize(), data)) {
+            return GetResult::ReadError;
+        }
+        // 复制出 mmap 区域后作为干净的数据留在内存中，再次换出时不需要重写日志
+        found->load(SharedBuffer::copyOf(data));
+        resident_value_bytes_ += found->storedSize();
+        --spilled_values_;
+        ++tiered_reads_;
+    }
+    ++keyspace_hits_;
+    found->touch();
+    value = *found;
+    return GetResult::Found;
+}
+
+void Store::prefetch(std::string_view key) const {
+    const Value* found = data_.find(key);
+    if (found && !found->resident()) {
+        log_->prefetch(found->location(), found->storedSize());
+    }
+}
+
+bool Store::coldValueCached(std::string_view key) const {
+    const Value* found = data_.find(key);
+    if (found == nullptr || found->resident() ||
+        log_->cached(found->location(), found->storedSize())) {
+        return true;
+    }
+    log_->prefetch(found->location(), found->storedSize());
+    return false;
+}
+
+bool Store::spill(const std::string& key, Value& value) {
+    if (value.location() == Value::NO_LOCATION) {
+        uint64_t location;
+        if (!log_->append(key, value.data(), location)) {
+            return false;
+        }
+        value.setLocation(location);
+    }
+    value.evict();
+    resident_value_bytes_ -= value.storedSize();
+    ++spilled_values_;
+    ++tiered_evictions_;
+    return true;
+}
+
+void Store::evictValues(size_t max_buckets, std::chrono::steady_clock::time_point deadline) {
+    static constexpr size_t BUCKETS_PER_CLOCK_CHECK{16};
+    // 单个 value 写入失败时跳过它继续扫描；连续失败这么多次说明磁盘已满，本次不再尝试
+    static constexpr int MAX_SPILL_FAILURES{8};
+
+    // CLOCK：指针扫过时清除访问位，再次扫到仍未被访问的 value 才换出；
+    // 指针绕回两次仍未回到上限以下（剩下的 value 都太小或太大）时停止，交给下一次定时任务
+    size_t buckets = 0;
+    int wraps = 0;
+    int failures = 0;
+    while (resident_value_bytes_ > tiered_.max_memory && failures < MAX_SPILL_FAILURES &&
+           buckets < max_buckets && wraps < 2) {
+        evict_cursor_ = data_.scan(evict_cursor_, [&](const std::string& key, Value& value) {
+            // 放不进一个段的记录永远写不进日志，不作为候选
+            if (failures >= MAX_SPILL_FAILURES || resident_value_bytes_ <= tiered_.max_memory ||
+                !value.resident() || value.storedSize() == 0 ||
+                value.storedSize() < tiered_.min_value_size ||
+                ValueLog::recordSize(key.size(), value.storedSize()) > ValueLog::SEGMENT_SIZE) {
+                return;
+            }
+            if (value.referenced()) {
+                value.clearReferenced();
+            } else if (spill(key, value)) {
+                failures = 0;
+            } else {
+                ++failures;
+                value.touch();  // 指针下次扫到时只清除访问位，隔一轮再重试
+            }
+        });
+        if (evict_cursor_ == 0) {
+            ++wraps;
+        }
+        if (++buckets % BUCKETS_PER_CLOCK_CHECK == 0 &&
+            std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+    }
+}
+
+void Store::evictColdValues(std::chrono::steady_clock::time_point deadline) {
+    if (log_ && resident_value_bytes_ > tiered_.max_memory) {
+        evictValues(SIZE_MAX, deadline);
+    }
+}
+
+void Store::compactValueLog(std::chrono::steady_clock::time_point deadline) {
+    static constexpr size_t RECORDS_PER_CLOCK_CHECK{32};
+
+    if (!log_) {
+        return;
+    }
+    if (compact_segment_ == 0) {
+        if (!log_->pickSegment(tiered_.compact_garbage_percent, compact_segment_)) {
+            return;
+        }
+        compact_offset_ = 0;
+    }
+    // 整段都是垃圾时直接删除，不需要读出记录
+    size_t records = 0;
+    std::string_view key, data;
+    uint64_t location;
+    size_t next;
+    while (log_->segmentLiveBytes(compact_segment_) > 0 &&
+           log_->recordAt(compact_segment_, compact_offset_, key, data, location, next)) {
+        Value* value = data_.find(key);
+        if (value && value->location() == location) {
+            if (value->resident()) {
+                // 内存中还有数据，只需忘掉旧位置，下次换出时再写入
+                log_->release(location, key.size(), data.size());
+                value->setLocation(Value::NO_LOCATION);
+            } else {
+                uint64_t moved;
+                if (!log_->append(key, data, moved)) {
+                    return;  // 磁盘空间不足，下次从同一条记录继续
+                }
+                log_->release(location, key.size(), data.size());
+                value->setLocation(moved);
+                tiered_compacted_bytes_ += ValueLog::recordSize(key.size(), data.size());
+            }
+        }
+        compact_offset_ = next;
+        if (++records % RECORDS_PER_CLOCK_CHECK == 0 &&
+            std::chrono::steady_clock::now() >= deadline) {
+            return;
+        }
+    }
+    log_->removeSegment(compact_segment_);
+    compact_segment_ = 0;
 }
 
 bool Store::setExpire(const std::string& key, int seconds) {
-    if (seconds <= 0 || data_.find(key) == data_.end()) {
+    if (seconds <= 0 || data_.find(key) == nullptr) {
         return false;  // 无效的过期时间或键不存在
     }
 
     auto expire_time = std::chrono::system_clock::now() + std::chrono::seconds(seconds);
-    expirations_[key] = expire_time;
+    expirations_.insert(key).first->value = expire_time;
+    Tracking::getInstance().invalidate(key);
 
     // Log EXPIRE command in RESP format
-    std::vector<std::string_view> command = {"EXPIRE", key, std::to_string(seconds)};
+    std::string ttl = std::to_string(seconds);
+    std::vector<std::string_view> command = {"EXPIRE", key, ttl};
     logCommand(command);
     return true;
 }
 
 void Store::cleanupExpiredKeys() {
+    expire_cursor_ = 0;
+    activeExpireCycle(std::chrono::steady_clock::time_point::max());
+}
+
+size_t Store::activeExpireCycle(std::chrono::steady_clock::time_point deadline) {
+    // 每访问这么多个 bucket 检查一次时间，避免频繁读时钟
+    static constexpr size_t BUCKETS_PER_CLOCK_CHECK{16};
+
     auto now = std::chrono::system_clock::now();
-    for (auto it = expirations_.begin(); it != expirations_.end();) {
-        if (now >= it->second) {
-            data_.erase(it->first);
-            it = expirations_.erase(it);
-        } else {
-            ++it;
+    // 惰性过期时只摘下节点，整批交给后台线程释放
+    std::vector<std::unique_ptr<Dict<Value>::Entry>> garbage;
+    std::vector<std::string> expired;
+    size_t removed = 0;
+    size_t buckets = 0;
+    do {
+        expire_cursor_ =
+            expirations_.scan(expire_cursor_, [&](const std::string& key, const time_point& when) {
+                if (now >= when) {
+                    expired.push_back(key);
+                }
+            });
+        // 遍历完一个 bucket 后再删除，scan 回调中不能修改表
+        for (const auto& key : expired) {
+            expireKey(key, garbage);
+        }
+        removed += expired.size();
+        expired.clear();
+    } while (expire_cursor_ != 0 && (++buckets % BUCKETS_PER_CLOCK_CHECK != 0 ||
+                                     std::chrono::steady_clock::now() < deadline));
+
+    if (!garbage.empty()) {
+        size_t objects = garbage.size();
+        lazy_free_.free(std::move(garbage), objects);
+    }
+    return removed;
+}
+
+void Store::expireKey(const std::string& key,
+                      std::vector<std::unique_ptr<Dict<Value>::Entry>>& garbage) {
+    Tracking::getInstance().invalidate(key);
+    auto entry = data_.unlink(key);
+    if (entry) {
+        removeValueStats(key, entry->value);
+    }
+    if (lazyfree_lazy_expire_ && entry) {
+        garbage.push_back(std::move(entry));
+    }
+    expirations_.erase(key);
+    ++expired_keys_;
+}
+
+bool Store::del(const std::string& key, bool lazy) {
+    // 已过期的键在逻辑上已不存在：不写 DEL、不发失效消息，留给过期清理删除并通知
+    if (isExpired(key)) {
+        return false;
+    }
+    auto entry = data_.unlink(key);
+    if (!entry) {
+        return false;
+    }
+    removeValueStats(key, entry->value);
+    expirations_.erase(key);
+
+    Tracking::getInstance().invalidate(key);
+
+    if (lazy && entry->value.storedSize() >= LAZYFREE_THRESHOLD) {
+        lazy_free_.free(std::move(entry));
+    }
+
+    // Log DEL command in RESP format
+    std::vector<std::string_view> command = {"DEL", key};
+    logCommand(command);
+    return true;
+}
+
+void Store::flushAll(bool lazy) {
+    if (lazy) {
+        // 事件循环只交换指针，节点的释放全部在后台完成
+        size_t objects = data_.size() + expirations_.size();
+        lazy_free_.free(std::make_pair(std::move(data_), std::move(expirations_)), objects);
+    }
+    data_.clear();
+    expirations_.clear();
+    compressed_values_ = 0;
+    compressed_raw_bytes_ = 0;
+    compressed_stored_bytes_ = 0;
+    resident_value_bytes_ = 0;
+    spilled_values_ = 0;
+    evict_cursor_ = 0;
+    compact_segment_ = 0;
+    if (log_) {
+        log_->clear();
+    }
+    Tracking::getInstance().invalidateAll();
+
+    std::vector<std::string_view> command = {"FLUSHALL"};
+    logCommand(command);
+}
+
+uint64_t Store::scan(uint64_t cursor, size_t count, std::string_view pattern,
+                     std::vector<std::string>& keys) const {
+    bool match_all = pattern.empty() || pattern == "*";
+    if (!match_all && globIsLiteral(pattern)) {
+        std::string key(pattern);
+        if (cursor == 0 && data_.find(key) && !isExpired(key)) {
+            keys.push_back(std::move(key));
+        }
+        return 0;
+    }
+    return scanEntries(cursor, count, [&](const std::string& key, const Value&) {
+        if (match_all || globMatch(pattern, key)) {
+            keys.push_back(key);
+        }
+    });
+}
+
+std::vector<std::string> Store::keys(std::string_view pattern) const {
+    std::vector<std::string> result;
+    bool match_all = pattern == "*";
+    if (!match_all && globIsLiteral(pattern)) {
+        std::string key(pattern);
+        if (data_.find(key) && !isExpired(key)) {
+            result.push_back(std::move(key));
         }
+        return result;
     }
+    data_.forEach([&](const std::string& key, const Value&) {
+        if ((match_all || globMatch(pattern, key)) && !isExpired(key)) {
+            result.push_back(key);
+        }
+    });
+    return result;
+}
+
+bool Store::isExpired(const std::string& key) const {
+    const time_point* when = expirations_.find(key);
+    return when && std::chrono::system_clock::now() >= *when;
 }
 
 void Store::logCommand(const std::vector<std::string_view>& command) {
-    if (!aof_.is_open()) {
+    if (aof_fd_ < 0) {
         return;
     }
 
-    aof_ << "*" << command.size() << "\r\n";
+    auto start = Stats::Clock::now();
+    std::string record = "*" + std::to_string(command.size()) + "\r\n";
     for (const auto& arg : command) {
-        aof_ << "$" << arg.size() << "\r\n" << arg << "\r\n";
+        record += "$" + std::to_string(arg.size()) + "\r\n";
+        record += arg;
+        record += "\r\n";
+    }
+    size_t written = 0;
+    while (written < record.size()) {
+        ssize_t n = write(aof_fd_, record.data() + written, record.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+    aof_last_write_ok_ = written == record.size();
+    aof_size_ += written;
+    if (aof_fsync_ == AofFsync::Always) {
+        fsyncAof();
+    }
+
+    auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(Stats::Clock::now() - start);
+    Stats::getInstance().recordLatency("aof-write", static_cast<uint64_t>(elapsed.count()));
+}
+
+void Store::fsyncAof() {
+    if (aof_fd_ < 0 || aof_synced_size_ == aof_size_) {
+        return;
+    }
+    auto start = Stats::Clock::now();
+    if (fdatasync(aof_fd_) == 0) {
+        aof_synced_size_ = aof_size_;
+    } else {
+        aof_last_write_ok_ = false;
     }
-    aof_.flush();
+    auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(Stats::Clock::now() - start);
+    Stats::getInstance().recordLatency("aof-fsync", static_cast<uint64_t>(elapsed.count()));
 }
 
 void Store::replayAof() {
@@ -113,6 +509,7 @@ void Store::replayAof() {
     std::string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
 
     // 逐步解析 buffer 中的 RESP 消息
+    loading_ = true;
     size_t offset = 0;
     while (offset < buffer.size()) {
         size_t consumed = 0;
@@ -128,6 +525,7 @@ void Store::replayAof() {
         offset += consumed;
     }
 
+    loading_ = false;
     // std::cout << "AOF replay completed successfully\n";
 
     file.close();
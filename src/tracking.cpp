@@ -0,0 +1,182 @@
+#include "tracking.hpp"
+
+#include <vector>
+
+namespace {
+    // RESP3 推送类型，客户端可以与普通回复区分开
+    std::string invalidateMessage(const std::string* key) {
+        std::string msg = ">2\r\n$10\r\ninvalidate\r\n";
+        if (key == nullptr) {
+            msg += "_\r\n";  // 空值表示全部失效
+        } else {
+            msg += "*1\r\n$" + std::to_string(key->size()) + "\r\n" + *key + "\r\n";
+        }
+        return msg;
+    }
+}
+
+Tracking& Tracking::getInstance() {
+    static Tracking instance;
+    return instance;
+}
+
+void Tracking::addClient(Client& client) { clients_[client.id] = &client; }
+
+void Tracking::removeClient(Client& client) {
+    disable(client);
+    clients_.erase(client.id);
+}
+
+Client* Tracking::findClient(uint64_t id) const {
+    auto it = clients_.find(id);
+    return it == clients_.end() ? nullptr : it->second;
+}
+
+void Tracking::enable(Client& client) {
+    if (client.tracking) {
+        return;
+    }
+    client.tracking = true;
+    ++tracking_clients_;
+    if (client.tracking_bcast) {
+        if (client.tracking_prefixes.empty()) {
+            client.tracking_prefixes.emplace_back();  // 空前缀匹配所有键
+        }
+        for (const auto& prefix : client.tracking_prefixes) {
+            prefixes_[prefix].insert(client.id);
+        }
+    }
+}
+
+void Tracking::disable(Client& client) {
+    if (!client.tracking) {
+        return;
+    }
+    for (const auto& prefix : client.tracking_prefixes) {
+        auto it = prefixes_.find(prefix);
+        if (it != prefixes_.end()) {
+            it->second.erase(client.id);
+            if (it->second.empty()) {
+                prefixes_.erase(it);
+            }
+        }
+    }
+    // 默认模式下 keys_ 中残留的 id 在失效时按需跳过，无需在这里扫描整张表
+    client.tracking = false;
+    client.tracking_bcast = false;
+    client.tracking_noloop = false;
+    client.tracking_redirect = 0;
+    client.tracking_prefixes.clear();
+    --tracking_clients_;
+}
+
+void Tracking::trackRead(const Client& client, std::string_view key) {
+    if (!client.tracking || client.tracking_bcast) {
+        return;
+    }
+    auto it = keys_.find(key);
+    if (it == keys_.end()) {
+        it = keys_.emplace(std::string(key), std::unordered_set<uint64_t>{}).first;
+        it->second.insert(client.id);
+        if (keys_.size() > max_keys_) {
+            evictKeys();
+        }
+        return;
+    }
+    it->second.insert(client.id);
+}
+
+void Tracking::invalidate(std::string_view key) {
+    if (tracking_clients_ == 0) {
+        return;
+    }
+    if (!keys_.empty()) {
+        auto it = keys_.find(key);
+        if (it != keys_.end()) {
+            // 先摘下记录再发送，失效是一次性的
+            auto node = keys_.extract(it);
+            for (uint64_t id : node.mapped()) {
+                sendInvalidation(id, &node.key());
+            }
+        }
+    }
+    if (!prefixes_.empty()) {
+        std::string owned;
+        for (const auto& [prefix, ids] : prefixes_) {
+            if (key.substr(0, prefix.size()) != prefix) {
+                continue;
+            }
+            if (owned.empty()) {
+                owned = key;
+            }
+            for (uint64_t id : ids) {
+                sendInvalidation(id, &owned);
+            }
+        }
+    }
+}
+
+void Tracking::invalidateAll() {
+    if (tracking_clients_ == 0) {
+        keys_.clear();
+        return;
+    }
+    keys_.clear();
+    std::vector<uint64_t> ids;
+    for (const auto& [id, client] : clients_) {
+        if (client->tracking) {
+            ids.push_back(id);
+        }
+    }
+    for (uint64_t id : ids) {
+        sendInvalidation(id, nullptr);
+    }
+}
+
+void Tracking::setMaxKeys(size_t max_keys) {
+    max_keys_ = max_keys;
+    if (keys_.size() > max_keys_) {
+        evictKeys();
+    }
+}
+
+void Tracking::sendInvalidation(uint64_t client_id, const std::string* key) {
+    Client* client = findClient(client_id);
+    // 已断开或已关闭跟踪的客户端直接跳过（默认模式下 keys_ 中可能残留旧 id）
+    if (client == nullptr || !client->tracking) {
+        return;
+    }
+    if (client->tracking_noloop && client_id == current_client_ && key != nullptr) {
+        return;
+    }
+    Client* target = client;
+    if (client->tracking_redirect != 0) {
+        target = findClient(client->tracking_redirect);
+        if (target == nullptr) {
+            return;
+        }
+    }
+    // 开启跟踪后又 HELLO 2 切回 RESP2 的连接不再接收推送，否则会打乱它的请求与回复的对应
+    if (target->resp < 3) {
+        return;
+    }
+    if (target->id == current_client_) {
+        // 目标正在执行命令，响应可能只写了一部分，由 Server 在命令结束后追加
+        target->pending_pushes += invalidateMessage(key);
+        return;
+    }
+    target->response.append(invalidateMessage(key));
+    if (on_output_) {
+        on_output_(*target);
+    }
+}
+
+void Tracking::evictKeys() {
+    // 超出上限时逐出任意键；通知读过它的客户端，保证客户端不会持有过期缓存
+    while (keys_.size() > max_keys_) {
+        auto node = keys_.extract(keys_.begin());
+        for (uint64_t id : node.mapped()) {
+            sendInvalidation(id, &node.key());
+        }
+    }
+}
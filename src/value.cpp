@@ -0,0 +1,62 @@
+#include "value.hpp"
+
+#include <climits>
+#include <stdexcept>
+
+#include "lz.hpp"
+
+Value Value::make(std::string_view raw, size_t compress_threshold) {
+    if (compress_threshold == 0 || raw.size() < compress_threshold) {
+        return Value(raw);
+    }
+    // 压缩后超过原大小的 7/8 时放弃，节省的内存抵不上每次读取的解压开销
+    std::string compressed;
+    if (!lzCompress(raw, raw.size() - raw.size() / 8, compressed)) {
+        return Value(raw);
+    }
+    Value value;
+    value.data_ = SharedBuffer::copyOf(compressed);
+    value.size_ = raw.size();
+    value.stored_size_ = compressed.size();
+    return value;
+}
+
+bool Value::fromCompressed(std::string_view data, size_t raw_size, Value& value) {
+    // 长度来自 AOF，分配之前先排除编码不可能产生的长度与超过 bulk 字符串上限的长度
+    if (data.size() >= raw_size || raw_size / LZ_MAX_RATIO > data.size() ||
+        raw_size > static_cast<size_t>(INT_MAX)) {
+        return false;
+    }
+    // 先完整解压一次校验数据，之后读取时不会再失败
+    std::string raw(raw_size, '\0');
+    if (!lzDecompress(data, raw.data(), raw_size)) {
+        return false;
+    }
+    value.data_ = SharedBuffer::copyOf(data);
+    value.size_ = raw_size;
+    value.stored_size_ = data.size();
+    return true;
+}
+
+SharedBuffer Value::raw() const {
+    if (!compressed()) {
+        return data_;
+    }
+    SharedBuffer raw = SharedBuffer::allocate(size_);
+    if (!lzDecompress(data_.view(), raw.writableData(), size_)) {
+        // 只有 fromCompressed 校验过或 make 生成的数据才会以压缩形式保存
+        throw std::logic_error("corrupted compressed value");
+    }
+    return raw;
+}
+
+std::string Value::str() const {
+    if (!compressed()) {
+        return std::string(data_.view());
+    }
+    std::string raw(size_, '\0');
+    if (!lzDecompress(data_.view(), raw.data(), size_)) {
+        throw std::logic_error("corrupted compressed value");
+    }
+    return raw;
+}
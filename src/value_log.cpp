@@ -0,0 +1,228 @@
+#include "value_log.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    // madvise 与 mincore 要求起始地址按页对齐，返回覆盖 [data, data + size) 的对齐区间
+    void pageRange(const char* data, size_t size, uintptr_t& aligned, size_t& length) {
+        static const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        auto begin = reinterpret_cast<uintptr_t>(data);
+        aligned = begin & ~(page - 1);
+        length = size + (begin - aligned);
+    }
+}  // namespace
+
+ValueLog::ValueLog(std::string path) : path_(std::move(path)) {
+    // 上次运行残留的段文件已经没有用处，数据会从 AOF 重新加载
+    namespace fs = std::filesystem;
+    fs::path base(path_);
+    fs::path dir = base.has_parent_path() ? base.parent_path() : fs::path(".");
+    std::string prefix = base.filename().string() + ".";
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+            name.find_first_not_of("0123456789", prefix.size()) == std::string::npos) {
+            fs::remove(entry.path(), ec);
+        }
+    }
+    // 提前创建第一个段，路径不可写时启动即失败
+    active_ = next_id_++;
+    openSegment(active_);
+}
+
+ValueLog::~ValueLog() {
+    for (auto& [id, segment] : segments_) {
+        closeSegment(id, segment);
+    }
+}
+
+std::string ValueLog::segmentPath(uint32_t id) const { return path_ + "." + std::to_string(id); }
+
+ValueLog::Segment& ValueLog::openSegment(uint32_t id) {
+    std::string path = segmentPath(id);
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create value log segment " + path + ": " +
+                                 strerror(errno));
+    }
+    // 稀疏文件，只有写入的部分占用磁盘；整段映射后地址不会因追加而变化
+    void* map = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(SEGMENT_SIZE)) == 0) {
+        map = mmap(nullptr, SEGMENT_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (map == MAP_FAILED) {
+        close(fd);
+        unlink(path.c_str());
+        throw std::runtime_error("Failed to map value log segment " + path);
+    }
+    // 冷数据的访问是随机的，内核默认的预读只会读入用不到的页
+    madvise(map, SEGMENT_SIZE, MADV_RANDOM);
+    Segment& segment = segments_[id];
+    segment.fd = fd;
+    segment.map = static_cast<char*>(map);
+    return segment;
+}
+
+void ValueLog::closeSegment(uint32_t id, Segment& segment) {
+    munmap(segment.map, SEGMENT_SIZE);
+    if (segment.fd >= 0) {
+        close(segment.fd);
+    }
+    unlink(segmentPath(id).c_str());
+}
+
+bool ValueLog::append(std::string_view key, std::string_view value, uint64_t& location) {
+    size_t record = recordSize(key.size(), value.size());
+    if (record > SEGMENT_SIZE) {
+        return false;
+    }
+    auto it = segments_.find(active_);
+    if (it == segments_.end() || it->second.size + record > SEGMENT_SIZE) {
+        try {
+            uint32_t id = next_id_++;
+            openSegment(id);
+            if (it != segments_.end()) {
+                // 写满的段只通过映射读取，关闭 fd 后映射仍然有效，fd 数不随段数增长
+                close(it->second.fd);
+                it->second.fd = -1;
+            }
+            active_ = id;
+            it = segments_.find(id);
+        } catch (const std::exception&) {
+            return false;  // 磁盘或映射空间不足，value 继续留在内存中
+        }
+    }
+    Segment& segment = it->second;
+
+    uint32_t header[2] = {static_cast<uint32_t>(key.size()), static_cast<uint32_t>(value.size())};
+    iovec iov[3] = {{header, sizeof(header)},
+                    {const_cast<char*>(key.data()), key.size()},
+                    {const_cast<char*>(value.data()), value.size()}};
+    ssize_t written = pwritev(segment.fd, iov, 3, static_cast<off_t>(segment.size));
+    if (written != static_cast<ssize_t>(record)) {
+        return false;  // 没有推进 size，下一次写入会覆盖这里的残留数据
+    }
+    location = (static_cast<uint64_t>(active_) << 32) | (segment.size + HEADER_SIZE + key.size());
+    segment.size += record;
+    segment.live += record;
+    disk_bytes_ += record;
+    live_bytes_ += record;
+    return true;
+}
+
+bool ValueLog::read(uint64_t location, size_t size, std::string_view& data) const {
+    auto it = segments_.find(static_cast<uint32_t>(location >> 32));
+    size_t offset = location & 0xffffffffu;
+    if (it == segments_.end() || offset + size > it->second.size) {
+        return false;
+    }
+    data = {it->second.map + offset, size};
+    return true;
+}
+
+bool ValueLog::cached(uint64_t location, size_t size) const {
+    auto it = segments_.find(static_cast<uint32_t>(location >> 32));
+    if (it == segments_.end()) {
+        return true;  // 由 read 报告错误
+    }
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t aligned;
+    size_t length;
+    pageRange(it->second.map + (location & 0xffffffffu), size, aligned, length);
+    std::vector<unsigned char> pages((length + page - 1) / page);
+    if (mincore(reinterpret_cast<void*>(aligned), length, pages.data()) < 0) {
+        return true;  // 无法判断时按已缓存处理，读取可能阻塞但不会永远等待
+    }
+    return std::all_of(pages.begin(), pages.end(), [](unsigned char p) { return p & 1; });
+}
+
+void ValueLog::prefetch(uint64_t location, size_t size) const {
+    auto it = segments_.find(static_cast<uint32_t>(location >> 32));
+    if (it == segments_.end()) {
+        return;
+    }
+    uintptr_t aligned;
+    size_t length;
+    pageRange(it->second.map + (location & 0xffffffffu), size, aligned, length);
+    madvise(reinterpret_cast<void*>(aligned), length, MADV_WILLNEED);
+}
+
+void ValueLog::release(uint64_t location, size_t key_size, size_t value_size) {
+    auto it = segments_.find(static_cast<uint32_t>(location >> 32));
+    if (it == segments_.end()) {
+        return;
+    }
+    size_t record = recordSize(key_size, value_size);
+    it->second.live -= record;
+    live_bytes_ -= record;
+}
+
+void ValueLog::clear() {
+    for (auto& [id, segment] : segments_) {
+        closeSegment(id, segment);
+    }
+    segments_.clear();
+    disk_bytes_ = 0;
+    live_bytes_ = 0;
+    active_ = 0;
+}
+
+bool ValueLog::pickSegment(int min_garbage_percent, uint32_t& segment) const {
+    size_t best_garbage = 0;
+    for (const auto& [id, seg] : segments_) {
+        if (id == active_ || seg.size == 0) {
+            continue;
+        }
+        size_t garbage = seg.size - seg.live;
+        if (garbage * 100 >= seg.size * static_cast<size_t>(min_garbage_percent) &&
+            garbage > best_garbage) {
+            best_garbage = garbage;
+            segment = id;
+        }
+    }
+    return best_garbage > 0;
+}
+
+bool ValueLog::recordAt(uint32_t segment, size_t offset, std::string_view& key,
+                        std::string_view& value, uint64_t& location, size_t& next) const {
+    auto it = segments_.find(segment);
+    if (it == segments_.end() || offset + HEADER_SIZE > it->second.size) {
+        return false;
+    }
+    const char* base = it->second.map;
+    uint32_t header[2];
+    std::memcpy(header, base + offset, sizeof(header));
+    size_t value_offset = offset + HEADER_SIZE + header[0];
+    key = {base + offset + HEADER_SIZE, header[0]};
+    value = {base + value_offset, header[1]};
+    location = (static_cast<uint64_t>(segment) << 32) | value_offset;
+    next = value_offset + header[1];
+    return true;
+}
+
+size_t ValueLog::segmentLiveBytes(uint32_t segment) const {
+    auto it = segments_.find(segment);
+    return it == segments_.end() ? 0 : it->second.live;
+}
+
+void ValueLog::removeSegment(uint32_t segment) {
+    auto it = segments_.find(segment);
+    if (it == segments_.end()) {
+        return;
+    }
+    disk_bytes_ -= it->second.size;
+    live_bytes_ -= it->second.live;
+    closeSegment(segment, it->second);
+    segments_.erase(it);
+}